@@ -0,0 +1,332 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+# Copyright 2025 RnD Center "ELVEES", JSC
+
+"""
+Generator of SBIMG chains for sbimage-bench.elf.
+
+Creates RSA-3072 root and end-entity certificates, OTP dump with ROTPK, DUK and serial number,
+and plain, signed, encrypted, manifest and compressed chains of the same payload. The last
+payload of compressed-exec chain is executable, its entry address is placed beyond the LZ4
+frame. Keys, certificates and AES operations are made by openssl command line tool, LZ4 frames
+are made by lz4 command line tool.
+"""
+
+import argparse
+import hashlib
+import os
+import struct
+import subprocess
+from typing import List, Optional, Tuple
+
+SBIMG_HEADER_MAGIC = 0x53424D47
+HEADER_SIZE = 96
+AES_BLOCK_LEN = 16
+OTP_SIZE = 512
+
+TYPE_PAYLOAD_NO_RETURN = 0
+TYPE_ENCRYPTION_KEY = 1
+TYPE_ROOT_CERTIFICATE = 2
+TYPE_NON_ROOT_CERTIFICATE = 3
+TYPE_PAYLOAD_NO_EXEC = 5
+TYPE_MANIFEST = 6
+
+FLAG_CHECKSUM = 1 << 3
+FLAG_ENCRYPTED = 1 << 4
+FLAG_SIGN_OF_ENCRYPTED = 1 << 5
+FLAG_SIGNED = 1 << 6
+FLAG_COMPRESSED = 1 << 8
+
+ROOT_CERT_ID = 1
+EE_CERT_ID = 2
+AES_KEY_NUMBER = 2
+IV = bytes(range(1, AES_BLOCK_LEN + 1))
+
+EXTENSIONS = """[ca]
+basicConstraints=critical,CA:TRUE
+keyUsage=keyCertSign
+[ee]
+basicConstraints=critical,CA:FALSE
+keyUsage=digitalSignature
+"""
+
+
+def openssl(*args: str, data: Optional[bytes] = None) -> bytes:
+    """
+    The function runs openssl command line tool
+
+    Args:
+        args (str):   Command line arguments
+        data (bytes): Data passed to standard input
+
+    Returns:
+        bytes: Standard output
+    """
+    return subprocess.run(
+        ["openssl", *args], input=data, stdout=subprocess.PIPE, check=True
+    ).stdout
+
+
+def aes_128(mode: str, key: bytes, data: bytes) -> bytes:
+    """
+    The function encrypts data by AES-128 with the fixed SBIMG IV and without padding
+
+    Args:
+        mode (str):     "ecb" or "cbc"
+        key (bytes):    AES key
+        data (bytes):   Data, multiple of AES block
+
+    Returns:
+        bytes: Ciphered data
+    """
+    args = ["enc", "-e", f"-aes-128-{mode}", "-nopad", "-K", key.hex()]
+    if mode != "ecb":
+        args += ["-iv", IV.hex()]
+    return openssl(*args, data=data)
+
+
+def lz4_frame(out: str, data: bytes) -> bytes:
+    """
+    The function compresses data to LZ4 frame with content size, it's required by SBL
+
+    Args:
+        out (str):    Output directory for temporary files
+        data (bytes): Plain data
+
+    Returns:
+        bytes: LZ4 frame
+    """
+    path = os.path.join(out, "payload.bin")
+    with open(path, "wb") as f:
+        f.write(data)
+    frame = subprocess.run(
+        ["lz4", "-9", "-q", "-c", "--content-size", path], stdout=subprocess.PIPE, check=True
+    ).stdout
+    os.remove(path)
+    return frame
+
+
+def compressible(size: int) -> bytes:
+    """
+    The function makes random data where half of 64-byte blocks repeat the previous ones
+
+    Args:
+        size (int): Size of data
+
+    Returns:
+        bytes: Data compressed by LZ4 about twice
+    """
+    blocks: List[bytes] = []
+    for rnd in os.urandom((size + 63) // 64):
+        blocks.append(blocks[-1 - rnd % len(blocks)] if blocks and rnd & 1 else os.urandom(64))
+    return b"".join(blocks)[:size]
+
+
+def der_length(der: bytes, offset: int) -> Tuple[int, int]:
+    """
+    The function decodes DER length field
+
+    Args:
+        der (bytes):  DER data
+        offset (int): Offset of the length field
+
+    Returns:
+        (int, int): Length of the value and offset of the value
+    """
+    length = der[offset]
+    if length < 0x80:
+        return length, offset + 1
+    count = length & 0x7F
+    return int.from_bytes(der[offset + 1 : offset + 1 + count], "big"), offset + 1 + count
+
+
+def tbs_digest(cert: bytes) -> bytes:
+    """
+    The function calculates SHA-256 of TBSCertificate, it's compared with ROTPK by SBL
+
+    Args:
+        cert (bytes): Certificate in DER format
+
+    Returns:
+        bytes: Digest
+    """
+    _, tbs = der_length(cert, 1)
+    length, value = der_length(cert, tbs + 1)
+    return hashlib.sha256(cert[tbs : value + length]).digest()
+
+
+def make_certs(out: str) -> Tuple[bytes, bytes, str]:
+    """
+    The function creates root certificate and end-entity certificate signed by it
+
+    Args:
+        out (str): Output directory
+
+    Returns:
+        (bytes, bytes, str): Root and end-entity certificates in DER, end-entity key path
+    """
+    ext = os.path.join(out, "ext.cnf")
+    with open(ext, "w") as f:
+        f.write(EXTENSIONS)
+
+    path = {name: os.path.join(out, name) for name in ("root.key", "root.pem", "ee.key", "ee.csr")}
+    for key in ("root.key", "ee.key"):
+        openssl("genrsa", "-out", path[key], "3072")
+
+    openssl("req", "-new", "-x509", "-sha256", "-days", "3650", "-key", path["root.key"],
+            "-subj", "/CN=SBIMG benchmark root", "-extensions", "ca", "-config", ext,
+            "-out", path["root.pem"])
+    openssl("req", "-new", "-sha256", "-key", path["ee.key"], "-subj", "/CN=SBIMG benchmark",
+            "-out", path["ee.csr"])
+    ee = openssl("x509", "-req", "-sha256", "-days", "3650", "-in", path["ee.csr"],
+                 "-CA", path["root.pem"], "-CAkey", path["root.key"], "-set_serial", "2",
+                 "-extfile", ext, "-extensions", "ee", "-outform", "DER")
+    root = openssl("x509", "-in", path["root.pem"], "-outform", "DER")
+
+    return root, ee, path["ee.key"]
+
+
+def sbimg_object(
+    payload: bytes,
+    obj_type: int,
+    flags: int = 0,
+    l_addr: int = 0,
+    e_addr: Optional[int] = None,
+    cert_id: int = 0,
+    sign_cert_id: int = 0,
+    key: Optional[str] = None,
+    cek: Optional[bytes] = None,
+) -> bytes:
+    """
+    The function builds SBIMG object: header, optional signature and payload
+
+    Args:
+        payload (bytes):    Plain payload
+        obj_type (int):     Object type
+        flags (int):        FLAG_CHECKSUM, FLAG_SIGN_OF_ENCRYPTED and FLAG_COMPRESSED flags,
+                            payload must be LZ4 frame if FLAG_COMPRESSED is set
+        l_addr (int):       Load address
+        e_addr (int):       Entry address, it's l_addr if it's None
+        cert_id (int):      ID of the certificate in the object
+        sign_cert_id (int): ID of the certificate used for the signature
+        key (str):          Path to the signing key, object isn't signed if it's None
+        cek (bytes):        Content encryption key, object isn't encrypted if it's None
+
+    Returns:
+        bytes: Object padded the same way as SBL steps over it
+    """
+    data = payload
+    if cek:
+        flags |= FLAG_ENCRYPTED
+        data = aes_128("cbc", cek, payload + bytes(-len(payload) % AES_BLOCK_LEN))
+    else:
+        flags &= ~FLAG_SIGN_OF_ENCRYPTED
+    if key:
+        flags |= FLAG_SIGNED
+
+    hashed = data if flags & FLAG_SIGN_OF_ENCRYPTED else payload
+    digest = hashlib.sha256(hashed).digest()
+    header = struct.pack(
+        "<8I", SBIMG_HEADER_MAGIC, len(payload), l_addr, l_addr if e_addr is None else e_addr,
+        obj_type | flags, AES_KEY_NUMBER, cert_id, sign_cert_id
+    ) + digest
+    header += hashlib.sha256(header + bytes(32)).digest()
+
+    signature = openssl("dgst", "-sha256", "-sign", key, data=hashed) if key else b""
+
+    obj = header + signature + data
+    align = AES_BLOCK_LEN if cek else 4
+    return obj + bytes(-len(obj) % align)
+
+
+def encrypted_key(duk: bytes, serial: int, cek: bytes) -> bytes:
+    """
+    The function encrypts CEK by KEK derived from DUK, serial number and key number
+
+    Args:
+        duk (bytes):  Device unique key
+        serial (int): Device serial number
+        cek (bytes):  Content encryption key
+
+    Returns:
+        bytes: Encrypted CEK
+    """
+    num = AES_KEY_NUMBER.to_bytes(2, "big")
+    prekey1 = bytes([0x80, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0]) + num
+    prekey2 = serial.to_bytes(4, "little") + bytes([0, 1, 0, 0, 0, 0, 0, 0]) + num + bytes(2)
+    k1 = aes_128("ecb", duk, prekey1)
+    kek = aes_128("ecb", k1, prekey2)
+    return aes_128("cbc", kek, cek)
+
+
+def write_otp(path: str, rotpk: bytes, duk: bytes, serial: int) -> None:
+    """
+    The function writes OTP dump in otp_t layout
+
+    Args:
+        path (str):    Output file
+        rotpk (bytes): Root of trust public key digest
+        duk (bytes):   Device unique key
+        serial (int):  Device serial number
+    """
+    otp = struct.pack("<4I", 0, 0, 0, serial) + duk + rotpk
+    with open(path, "wb") as f:
+        f.write(otp + bytes(OTP_SIZE - len(otp)))
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("-o", "--out", default=".", help="output directory")
+    parser.add_argument("-s", "--size", type=int, default=1 << 20, help="payload size in bytes")
+    parser.add_argument("-n", "--payloads", type=int, default=4, help="payloads in each chain")
+    parser.add_argument("--l-addr", type=lambda x: int(x, 0), default=0x40000000,
+                        help="load address of the first payload")
+    args = parser.parse_args()
+
+    os.makedirs(args.out, exist_ok=True)
+    root, ee, ee_key = make_certs(args.out)
+
+    duk = os.urandom(16)
+    serial = int.from_bytes(os.urandom(4), "little")
+    cek = os.urandom(16)
+    write_otp(os.path.join(args.out, "otp.bin"), tbs_digest(root), duk, serial)
+
+    payloads = [compressible(args.size) for _ in range(args.payloads)]
+    frames = [lz4_frame(args.out, p) for p in payloads]
+    l_addrs = [args.l_addr + i * ((args.size + 0xFFF) & ~0xFFF) for i in range(args.payloads)]
+    certs = sbimg_object(root, TYPE_ROOT_CERTIFICATE, cert_id=ROOT_CERT_ID)
+    certs += sbimg_object(ee, TYPE_NON_ROOT_CERTIFICATE, cert_id=EE_CERT_ID,
+                          sign_cert_id=ROOT_CERT_ID)
+    enc_key = sbimg_object(encrypted_key(duk, serial, cek), TYPE_ENCRYPTION_KEY,
+                           sign_cert_id=EE_CERT_ID, key=ee_key)
+    manifest = b"".join(hashlib.sha256(p).digest() for p in payloads)
+
+    def chain(prefix: bytes = b"", data: Optional[List[bytes]] = None, **kwargs) -> bytes:
+        return prefix + b"".join(
+            sbimg_object(p, TYPE_PAYLOAD_NO_EXEC, l_addr=a, sign_cert_id=EE_CERT_ID, **kwargs)
+            for p, a in zip(payloads if data is None else data, l_addrs)
+        )
+
+    # Entry address is beyond the LZ4 frame, but inside of the decompressed payload
+    exec_obj = sbimg_object(frames[-1], TYPE_PAYLOAD_NO_RETURN, FLAG_COMPRESSED, l_addrs[-1],
+                            l_addrs[-1] + args.size - 4, sign_cert_id=EE_CERT_ID, key=ee_key)
+
+    chains: List[Tuple[str, bytes]] = [
+        ("plain", chain(flags=FLAG_CHECKSUM)),
+        ("signed", chain(certs, key=ee_key)),
+        ("encrypted", chain(certs + enc_key, key=ee_key, cek=cek)),
+        ("encrypted-soe", chain(certs + enc_key, flags=FLAG_SIGN_OF_ENCRYPTED, key=ee_key,
+                                cek=cek)),
+        ("manifest", chain(certs + sbimg_object(manifest, TYPE_MANIFEST,
+                                                sign_cert_id=EE_CERT_ID, key=ee_key))),
+        ("compressed", chain(certs, frames, flags=FLAG_COMPRESSED, key=ee_key)),
+        ("compressed-exec", chain(certs, frames[:-1], flags=FLAG_COMPRESSED, key=ee_key) +
+         exec_obj),
+    ]
+    for name, data in chains:
+        with open(os.path.join(args.out, f"{name}.sbimg"), "wb") as f:
+            f.write(data)
+
+
+if __name__ == "__main__":
+    main()
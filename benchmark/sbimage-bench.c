@@ -0,0 +1,566 @@
+// SPDX-License-Identifier: MIT
+// Copyright 2025 RnD Center "ELVEES", JSC
+
+/**
+ * Host benchmark of SBIMG executor and crypto primitives. Images are read from RAM, OTP dump is
+ * read from the file made by gen-sbimg.py, payloads are loaded to the anonymous mapping placed
+ * at their load addresses.
+ */
+
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+
+#include <drivers/otp/otp.h>
+#include <libs/lz4/lz4.h>
+#include <libs/sbimage/sbexecutor.h>
+#include <libs/sbimage/sbimage.h>
+#include <libs/sbimage/status.h>
+#include <third-party/aes/aes.h>
+#include <third-party/crc/checksum.h>
+#include <third-party/crypto/bigint.h>
+#include <third-party/crypto/crypto.h>
+#include <third-party/crypto/crypto_misc.h>
+
+#define ITERATIONS_DEFAULT 10
+#define PRIMITIVE_SIZE     (1 << 20)
+#define RSA_ITERATIONS     100
+#define MAX_OBJECTS        64
+
+typedef struct {
+	sbimghdr_t hdr;
+	uintptr_t offset;
+	size_t size;
+	double check_us;
+	double update_us;
+	double rewind_us;
+} bench_obj_t;
+
+typedef enum {
+	PASS_CHECK,
+	PASS_UPDATE,
+	// Update pass after sblimg_rewind(), it reuses results of the untimed check pass
+	PASS_REWIND,
+} bench_pass_t;
+
+static otp_t otp;
+static const uint8_t *image;
+static size_t image_size;
+static uintptr_t load_base;
+static size_t load_size;
+
+static bench_obj_t objs[MAX_OBJECTS];
+static int obj_count;
+
+// Calls of read_img_func, each of them is a separate flash command on the target
+static unsigned long read_count;
+static unsigned long pass_reads[PASS_REWIND + 1];
+
+static const char *const type_names[] = {
+	[SBIMAGE_TYPE_PAYLOAD_NO_RETURN] = "payload",
+	[SBIMAGE_TYPE_ENCRYPTION_KEY] = "enc-key",
+	[SBIMAGE_TYPE_ROOT_CERTIFICATE] = "root-cert",
+	[SBIMAGE_TYPE_NON_ROOT_CERTIFICATE] = "cert",
+	[SBIMAGE_TYPE_PAYLOAD_WITH_RETURN] = "payload-ret",
+	[SBIMAGE_TYPE_PAYLOAD_NO_EXEC] = "payload-data",
+	[SBIMAGE_TYPE_MANIFEST] = "manifest",
+	[7] = "unknown",
+};
+
+otp_t *otp_get_dump(void)
+{
+	return &otp;
+}
+
+void otp_clean_dump(void)
+{
+}
+
+static double time_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static double mb_per_s(size_t size, double us)
+{
+	return (us > 0) ? size / us : 0;
+}
+
+static void *read_file(const char *path, size_t *size)
+{
+	FILE *f = fopen(path, "rb");
+	void *data = NULL;
+	long len;
+
+	if (!f)
+		return NULL;
+
+	if (!fseek(f, 0, SEEK_END) && (len = ftell(f)) > 0 && !fseek(f, 0, SEEK_SET)) {
+		data = malloc(len);
+		if (data && fread(data, 1, len, f) != (size_t)len) {
+			free(data);
+			data = NULL;
+		}
+		*size = len;
+	}
+	fclose(f);
+
+	return data;
+}
+
+static int read_img(void *dst, signed long offset, size_t size)
+{
+	if (offset < 0 || offset + size > image_size)
+		return -1;
+
+	memcpy(dst, image + offset, size);
+	read_count++;
+
+	return 0;
+}
+
+static void *copy_mem(void *dst, uintptr_t src, size_t size)
+{
+	return memcpy(dst, (const void *)src, size);
+}
+
+static int check_laddr(uintptr_t l_addr, uint32_t size)
+{
+	return (!load_size || l_addr < load_base || l_addr + size > load_base + load_size) ? -1 : 0;
+}
+
+static int check_eaddr(uintptr_t l_addr, uint32_t size, uintptr_t e_addr)
+{
+	return (e_addr < l_addr || e_addr >= l_addr + size) ? -1 : 0;
+}
+
+static bool is_payload(const sbimghdr_t *hdr)
+{
+	return hdr->flags_bits.obj_type == SBIMAGE_TYPE_PAYLOAD_NO_RETURN ||
+	       hdr->flags_bits.obj_type == SBIMAGE_TYPE_PAYLOAD_WITH_RETURN ||
+	       hdr->flags_bits.obj_type == SBIMAGE_TYPE_PAYLOAD_NO_EXEC;
+}
+
+// Split image into objects the same way as sblimg_check() steps over them
+static int parse_image(void)
+{
+	uintptr_t offset = 0;
+	uintptr_t load_end = 0;
+
+	obj_count = 0;
+	load_base = UINTPTR_MAX;
+
+	while (offset + HEADER_SIZE <= image_size) {
+		bench_obj_t *obj = &objs[obj_count];
+
+		if (obj_count == MAX_OBJECTS)
+			return -1;
+
+		memset(obj, 0, sizeof(*obj));
+		memcpy(&obj->hdr, image + offset, HEADER_SIZE);
+		if (obj->hdr.h_id != SBIMG_HEADER_MAGIC)
+			return -1;
+
+		size_t size = HEADER_SIZE + obj->hdr.pl_size;
+		if (obj->hdr.flags_bits.signed_obj)
+			size += RSA_MOD_LEN;
+		size = (obj->hdr.flags_bits.encrypted) ? COMPLETE_BLOCK_LENGTH(size) :
+		                                         ALIGN(size, 4);
+
+		if (is_payload(&obj->hdr)) {
+			size_t pl_size = COMPLETE_BLOCK_LENGTH(obj->hdr.pl_size);
+
+			// Compressed payload takes its content size, it's known if it's not ciphered
+			if (obj->hdr.flags_bits.compressed && !obj->hdr.flags_bits.encrypted) {
+				size_t data = offset + HEADER_SIZE;
+				lz4_stream_t lz4;
+
+				if (obj->hdr.flags_bits.signed_obj)
+					data += RSA_MOD_LEN;
+
+				lz4_stream_init(&lz4, NULL);
+				if (data + obj->hdr.pl_size > image_size ||
+				    lz4_stream_decode(&lz4, image + data, obj->hdr.pl_size) < 0 ||
+				    !lz4_stream_has_header(&lz4))
+					return -1;
+				pl_size = lz4.dst_size;
+			}
+
+			load_base = MIN(load_base, (uintptr_t)obj->hdr.l_addr);
+			load_end = MAX(load_end, (uintptr_t)obj->hdr.l_addr + pl_size);
+		}
+
+		obj->offset = offset;
+		obj->size = size;
+		offset += size;
+		obj_count++;
+	}
+
+	load_size = (load_end > load_base) ? load_end - load_base : 0;
+
+	return (offset == image_size && obj_count) ? 0 : -1;
+}
+
+// Payloads are loaded to their l_addr, so the load window must be mapped at the same address
+static void *map_load_window(void)
+{
+	void *addr;
+
+	if (!load_size)
+		return NULL;
+
+	addr = mmap((void *)load_base, load_size, PROT_READ | PROT_WRITE,
+	            MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+	if (addr == MAP_FAILED)
+		return NULL;
+
+	if (addr != (void *)load_base) {
+		munmap(addr, load_size);
+		return NULL;
+	}
+
+	return addr;
+}
+
+/**
+ * Payload without return stops the chain, nothing is executed on the host. Its entry address is
+ * checked after loading the same way as sblimg_finish() does it before the jump.
+ */
+static int object_status(bench_pass_t pass, int status, int i)
+{
+	uintptr_t e_addr;
+
+	if (status != ESBIMGBOOT_LOAD_FINISH || i != obj_count - 1)
+		return status;
+
+	return (pass == PASS_CHECK) ? ESBIMGBOOT_NO_ERR : sblimg_entry(&e_addr);
+}
+
+static int run_pass(bench_pass_t pass, int iterations)
+{
+	static const char *const pass_names[] = { "check", "update", "rewind" };
+	sb_mem_t sb_mem = {
+		.chck_laddr_func = check_laddr,
+		.chck_eaddr_func = check_eaddr,
+		.cpy_func = copy_mem,
+		.read_img_func = read_img,
+		.image_offset = 0,
+	};
+	int status = ESBIMGBOOT_NO_ERR;
+
+	pass_reads[pass] = 0;
+
+	for (int n = 0; n < iterations && status == ESBIMGBOOT_NO_ERR; n++) {
+		status = sblimg_init(&sb_mem);
+
+		if (pass == PASS_REWIND) {
+			for (int i = 0; i < obj_count && status == ESBIMGBOOT_NO_ERR; i++)
+				status = object_status(PASS_CHECK, sblimg_check(), i);
+
+			if (status == ESBIMGBOOT_NO_ERR)
+				status = sblimg_rewind(&sb_mem);
+		}
+
+		unsigned long reads = read_count;
+
+		for (int i = 0; i < obj_count && status == ESBIMGBOOT_NO_ERR; i++) {
+			double start = time_us();
+
+			status = (pass == PASS_CHECK) ? sblimg_check() : sblimg_update();
+			status = object_status(pass, status, i);
+
+			double us = time_us() - start;
+			if (pass == PASS_CHECK)
+				objs[i].check_us += us / iterations;
+			else if (pass == PASS_UPDATE)
+				objs[i].update_us += us / iterations;
+			else
+				objs[i].rewind_us += us / iterations;
+
+			if (status != ESBIMGBOOT_NO_ERR)
+				fprintf(stderr, "%s: object %d failed: 0x%x\n", pass_names[pass], i,
+				        status);
+		}
+
+		pass_reads[pass] += read_count - reads;
+		sblimg_abort();
+	}
+
+	pass_reads[pass] /= iterations;
+
+	return (status == ESBIMGBOOT_NO_ERR) ? 0 : -1;
+}
+
+static void print_flags(const sbimghdr_t *hdr)
+{
+	char flags[] = "-----";
+
+	if (hdr->flags_bits.checksum)
+		flags[0] = 'C';
+	if (hdr->flags_bits.signed_obj)
+		flags[1] = 'S';
+	if (hdr->flags_bits.encrypted)
+		flags[2] = 'E';
+	if (hdr->flags_bits.sign_of_encrypted)
+		flags[3] = 'X';
+	if (hdr->flags_bits.compressed)
+		flags[4] = 'Z';
+
+	printf("%-6s", flags);
+}
+
+static void print_time(double us, size_t size)
+{
+	if (us > 0)
+		printf(" %12.1f %9.2f", us, mb_per_s(size, us));
+	else
+		printf(" %12s %9s", "-", "-");
+}
+
+static int bench_image(const char *path, int iterations)
+{
+	void *window = NULL;
+	int status = 0;
+	double check_us = 0;
+	double update_us = 0;
+	double rewind_us = 0;
+
+	image = read_file(path, &image_size);
+	if (!image) {
+		fprintf(stderr, "%s: can't read image\n", path);
+		return -1;
+	}
+
+	if (parse_image()) {
+		fprintf(stderr, "%s: bad image layout\n", path);
+		status = -1;
+		goto end;
+	}
+
+	memset(pass_reads, 0, sizeof(pass_reads));
+	status = run_pass(PASS_CHECK, iterations);
+	if (status)
+		goto end;
+
+	window = map_load_window();
+	if (window) {
+		status = run_pass(PASS_UPDATE, iterations);
+		if (!status)
+			status = run_pass(PASS_REWIND, iterations);
+	} else if (load_size)
+		fprintf(stderr, "%s: can't map load window 0x%lx-0x%lx, update pass skipped\n",
+		        path, (unsigned long)load_base, (unsigned long)(load_base + load_size));
+	if (status)
+		goto end;
+
+	printf("%s: %d objects, %zu bytes, %d iterations\n", path, obj_count, image_size,
+	       iterations);
+	printf(" #  %-13s %-6s %10s %12s %9s %12s %9s %12s %9s\n", "type", "flags", "size",
+	       "check, us", "MB/s", "update, us", "MB/s", "rewind, us", "MB/s");
+
+	for (int i = 0; i < obj_count; i++) {
+		printf("%2d  %-13s ", i, type_names[objs[i].hdr.flags_bits.obj_type]);
+		print_flags(&objs[i].hdr);
+		printf(" %10u", objs[i].hdr.pl_size);
+		print_time(objs[i].check_us, objs[i].hdr.pl_size);
+		print_time(objs[i].update_us, objs[i].hdr.pl_size);
+		print_time(objs[i].rewind_us, objs[i].hdr.pl_size);
+		printf("\n");
+
+		check_us += objs[i].check_us;
+		update_us += objs[i].update_us;
+		rewind_us += objs[i].rewind_us;
+	}
+
+	printf("    %-13s %-6s %10zu", "total", "", image_size);
+	print_time(check_us, image_size);
+	print_time(update_us, image_size);
+	print_time(rewind_us, image_size);
+	printf("\n");
+	printf("    flash reads per pass: check %lu, update %lu, rewind %lu\n\n",
+	       pass_reads[PASS_CHECK], pass_reads[PASS_UPDATE], pass_reads[PASS_REWIND]);
+
+end:
+	if (window)
+		munmap(window, load_size);
+	free((void *)image);
+	image = NULL;
+
+	return status;
+}
+
+static void bench_sha256(uint8_t *buf, size_t size, int iterations)
+{
+	uint8_t digest[SHA256_SIZE];
+	SHA256_CTX ctx;
+	double start = time_us();
+
+	for (int i = 0; i < iterations; i++) {
+		SHA256_Init(&ctx);
+		SHA256_Update(&ctx, buf, size);
+		SHA256_Final(digest, &ctx);
+	}
+
+	printf("sha256          %9.2f MB/s\n", mb_per_s(size * iterations, time_us() - start));
+}
+
+static void bench_aes(uint8_t *buf, size_t size, int iterations)
+{
+	static const uint8_t key[AES_KEY_LEN] = { 0 };
+	static const uint8_t iv[AES_BLOCK_LEN] = { 0 };
+	struct AES_ctx ctx;
+	double start = time_us();
+
+	for (int i = 0; i < iterations; i++) {
+		AES_init_ctx_iv(&ctx, key, iv);
+		AES_CBC_decrypt_buffer(&ctx, buf, size);
+	}
+
+	printf("aes-128-cbc-dec %9.2f MB/s\n", mb_per_s(size * iterations, time_us() - start));
+}
+
+static void bench_crc32(uint8_t *buf, size_t size, int iterations)
+{
+	volatile uint32_t crc = 0;
+	double start = time_us();
+
+	for (int i = 0; i < iterations; i++)
+		crc ^= crc_32(buf, size);
+
+	printf("crc32           %9.2f MB/s\n", mb_per_s(size * iterations, time_us() - start));
+}
+
+// RSA public key operation with the key of the first root certificate found in the images
+static void bench_rsa(const uint8_t *cert, int cert_len)
+{
+	X509_CTX *x509 = NULL;
+	uint8_t block[RSA_MOD_LEN] = { 0 };
+
+	if (x509_new(cert, &cert_len, &x509) || !x509->rsa_ctx) {
+		fprintf(stderr, "rsa: can't parse root certificate\n");
+		goto end;
+	}
+
+	RSA_CTX *rsa = x509->rsa_ctx;
+	int len = rsa->num_octets;
+
+	if (len > RSA_MOD_LEN)
+		goto end;
+
+	// Message is less than the modulus as its top byte is zero
+	memset(block + 1, 0x5A, len - 1);
+
+	double start = time_us();
+
+	for (int i = 0; i < RSA_ITERATIONS; i++) {
+		bigint *bi = bi_import(rsa->bi_ctx, block, len);
+
+		bi_export(rsa->bi_ctx, RSA_public(rsa, bi), block, len);
+		block[0] = 0;
+	}
+
+	printf("rsa-%d-public %9.1f us\n", len * 8, (time_us() - start) / RSA_ITERATIONS);
+
+end:
+	if (x509)
+		x509_free(x509);
+#ifdef CONFIG_BIGINT_ARENA
+	bi_arena_reset();
+#endif
+}
+
+static void bench_primitives(const char *path, int iterations)
+{
+	uint8_t *buf = malloc(PRIMITIVE_SIZE);
+
+	if (!buf)
+		return;
+
+	for (size_t i = 0; i < PRIMITIVE_SIZE; i++)
+		buf[i] = i * 131 + 7;
+
+	printf("primitives: %d bytes, %d iterations\n", PRIMITIVE_SIZE, iterations);
+	bench_sha256(buf, PRIMITIVE_SIZE, iterations);
+	bench_aes(buf, PRIMITIVE_SIZE, iterations);
+	bench_crc32(buf, PRIMITIVE_SIZE, iterations);
+	free(buf);
+
+	if (!path)
+		return;
+
+	image = read_file(path, &image_size);
+	if (image && !parse_image() &&
+	    objs[0].hdr.flags_bits.obj_type == SBIMAGE_TYPE_ROOT_CERTIFICATE)
+		bench_rsa(image + objs[0].offset + HEADER_SIZE +
+		                  ((objs[0].hdr.flags_bits.signed_obj) ? RSA_MOD_LEN : 0),
+		          objs[0].hdr.pl_size);
+	free((void *)image);
+	image = NULL;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr,
+	        "Usage: %s [-n iterations] [-o otp.bin] image.sbimg...\n"
+	        "  -n  number of passes over each image and primitive buffer, default %d\n"
+	        "  -o  OTP dump made by gen-sbimg.py, default otp.bin\n",
+	        name, ITERATIONS_DEFAULT);
+}
+
+int main(int argc, char **argv)
+{
+	const char *otp_path = "otp.bin";
+	const char *rsa_image = NULL;
+	int iterations = ITERATIONS_DEFAULT;
+	int status = 0;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:o:h")) != -1) {
+		switch (opt) {
+		case 'n':
+			iterations = atoi(optarg);
+			break;
+		case 'o':
+			otp_path = optarg;
+			break;
+		default:
+			usage(argv[0]);
+			return (opt == 'h') ? 0 : 1;
+		}
+	}
+
+	if (optind == argc || iterations <= 0) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	size_t otp_size;
+	void *otp_dump = read_file(otp_path, &otp_size);
+	if (!otp_dump) {
+		fprintf(stderr, "%s: can't read OTP dump\n", otp_path);
+		return 1;
+	}
+	memcpy(&otp, otp_dump, MIN(otp_size, sizeof(otp)));
+	free(otp_dump);
+
+	for (int i = optind; i < argc; i++) {
+		if (bench_image(argv[i], iterations))
+			status = 1;
+		else if (!rsa_image && objs[0].hdr.flags_bits.obj_type ==
+		                               SBIMAGE_TYPE_ROOT_CERTIFICATE)
+			rsa_image = argv[i];
+	}
+
+	bench_primitives(rsa_image, iterations);
+
+	return status;
+}
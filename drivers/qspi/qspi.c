@@ -19,20 +19,43 @@
 		mmio_write_32((uintptr_t)reg_ptr, tmp);          \
 	} while (0)
 
+// Dummy data sent while receiving, only low BITSIZE + 1 bits are transferred
+#define QSPI_DUMMY_FRAME 0x3C3C3C3C
+
+typedef struct {
+	uint8_t *buf;
+	size_t left; // bytes which are not received yet
+	size_t frame_size; // bytes in a frame of the current phase
+	size_t tx_left; // dummy frames of the current phase which are not sent yet
+	size_t rx_left; // frames of the current phase which are not received yet
+	size_t depth; // frames allowed to be in flight
+} qspi_rx_state_t;
+
+static qspi_rx_state_t rx_state = { 0 };
+static unsigned int qspi_mode = QSPI_MODE_NORMAL;
+static bool qspi_burst = true;
+
 static qspi_regs_t *qspi_get_regs(void)
 {
 	return (qspi_regs_t *)BASE_ADDR_SERVICE_QSPI0;
 }
 
-static int qspi_xip_disable(void)
+int qspi_xip_set(unsigned int state)
 {
 	service_urb_regs_t *service_urb_regs = service_get_urb_registers();
 
-	if (service_urb_regs->qspi0_xip_en_out != QSPI_XIP_DISABLE)
-		service_urb_regs->qspi0_xip_en_req = QSPI_XIP_DISABLE;
+	if (state != QSPI_XIP_DISABLE && state != QSPI_XIP_ENABLE)
+		return -EINVALIDPARAM;
+
+	// XIP controller issues its own commands in 1-wire mode
+	if (state == QSPI_XIP_ENABLE)
+		qspi_set_mode(QSPI_MODE_NORMAL);
+
+	if (service_urb_regs->qspi0_xip_en_out != state)
+		service_urb_regs->qspi0_xip_en_req = state;
 
 	for (volatile int r = 0; r < UINT16_MAX; r++)
-		if (service_urb_regs->qspi0_xip_en_out == QSPI_XIP_DISABLE)
+		if (service_urb_regs->qspi0_xip_en_out == state)
 			return 0;
 
 	return -ETIMEOUT;
@@ -68,6 +91,7 @@ int qspi_write(const void *o_buff, size_t count)
 
 	// Prohibit writing to the fifo
 	qspi_write_reg(&qspi_regs->ctrl_aux, QSPI_CTRL_AUX_INHIBITDIN_MASK, 1);
+	qspi_write_reg(&qspi_regs->ctrl_aux, QSPI_CTRL_AUX_INHIBITDOUT_MASK, 0);
 
 	while (!(FIELD_GET(QSPI_STAT_TXEMPTY_MASK, qspi_regs->stat)) ||
 	       FIELD_GET(QSPI_STAT_XFERIP_MASK, qspi_regs->stat))
@@ -86,11 +110,9 @@ int qspi_write(const void *o_buff, size_t count)
 	return 0;
 }
 
-int qspi_read(void *i_buff, size_t count)
+// Legacy receiving by one byte, each byte waits for the previous one
+static int qspi_read_by_byte(void *i_buff, size_t count)
 {
-	if (!i_buff)
-		return -ENULL;
-
 	qspi_regs_t *qspi_regs = qspi_get_regs();
 
 	qspi_write_reg(&qspi_regs->ctrl_aux, QSPI_CTRL_AUX_BITSIZE_MASK, 7);
@@ -98,8 +120,10 @@ int qspi_read(void *i_buff, size_t count)
 	while (qspi_regs->rx_fifo_lvl)
 		qspi_regs->rx_data; // empty fifo
 
-	// Allow writing to fifo
+	// Allow writing to fifo, data lines are driven by the flash in dual and quad modes
 	qspi_write_reg(&qspi_regs->ctrl_aux, QSPI_CTRL_AUX_INHIBITDIN_MASK, 0);
+	qspi_write_reg(&qspi_regs->ctrl_aux, QSPI_CTRL_AUX_INHIBITDOUT_MASK,
+	               qspi_mode != QSPI_MODE_NORMAL);
 	for (unsigned int i = 0; i < count; i++) {
 		qspi_regs->tx_data = 0x3C;
 		while (FIELD_GET(QSPI_STAT_RXEMPTY_MASK, qspi_regs->stat))
@@ -110,12 +134,126 @@ int qspi_read(void *i_buff, size_t count)
 	return 0;
 }
 
+/*
+ * Select frame size for the next part of the buffer. 32-bit frames are used for the word aligned
+ * part of the buffer, bytes before and after it are received by 8-bit frames. Frame size is
+ * changed only when all frames of the previous phase are received.
+ */
+static void qspi_rx_next_phase(qspi_regs_t *qspi_regs)
+{
+	size_t head = (-(uintptr_t)rx_state.buf) & 3;
+	size_t count = rx_state.left;
+
+	if (!head && count >= 4) {
+		rx_state.frame_size = 4;
+		count = ALIGN_DOWN(count, 4);
+	} else {
+		rx_state.frame_size = 1;
+		if (count >= head + 4)
+			count = head;
+	}
+
+	rx_state.tx_left = count / rx_state.frame_size;
+	rx_state.rx_left = rx_state.tx_left;
+
+	qspi_write_reg(&qspi_regs->ctrl_aux, QSPI_CTRL_AUX_BITSIZE_MASK,
+	               rx_state.frame_size * 8 - 1);
+}
+
+int qspi_read_start(void *i_buff, size_t count)
+{
+	if (!i_buff)
+		return -ENULL;
+
+	qspi_regs_t *qspi_regs = qspi_get_regs();
+
+	while (qspi_regs->rx_fifo_lvl)
+		qspi_regs->rx_data; // empty fifo
+
+	rx_state.buf = (uint8_t *)i_buff;
+	rx_state.left = count;
+	rx_state.depth = MAX(qspi_regs->fifo_depth, 1U);
+	qspi_rx_next_phase(qspi_regs);
+
+	// Allow writing to fifo, data lines are driven by the flash in dual and quad modes
+	qspi_write_reg(&qspi_regs->ctrl_aux, QSPI_CTRL_AUX_INHIBITDIN_MASK, 0);
+	qspi_write_reg(&qspi_regs->ctrl_aux, QSPI_CTRL_AUX_INHIBITDOUT_MASK,
+	               qspi_mode != QSPI_MODE_NORMAL);
+
+	return 0;
+}
+
+int qspi_read_poll(void)
+{
+	qspi_regs_t *qspi_regs = qspi_get_regs();
+	size_t lvl;
+
+	if (!rx_state.left)
+		return 0;
+
+	// Drain received frames, the first transferred byte is the most significant one
+	lvl = MIN((size_t)qspi_regs->rx_fifo_lvl, rx_state.rx_left);
+	rx_state.rx_left -= lvl;
+	rx_state.left -= lvl * rx_state.frame_size;
+	if (rx_state.frame_size == 4) {
+		for (; lvl; lvl--) {
+			*(uint32_t *)rx_state.buf = __builtin_bswap32(qspi_regs->rx_data);
+			rx_state.buf += 4;
+		}
+	} else {
+		for (; lvl; lvl--)
+			*rx_state.buf++ = (uint8_t)qspi_regs->rx_data;
+	}
+
+	if (!rx_state.rx_left) {
+		if (!rx_state.left)
+			return 0;
+
+		qspi_rx_next_phase(qspi_regs);
+	}
+
+	// Keep the FIFO busy while the caller does something else, not more frames
+	// than RX FIFO can hold are in flight
+	while (rx_state.tx_left && (rx_state.rx_left - rx_state.tx_left) < rx_state.depth &&
+	       !FIELD_GET(QSPI_STAT_TXFULL_MASK, qspi_regs->stat)) {
+		qspi_regs->tx_data = QSPI_DUMMY_FRAME;
+		rx_state.tx_left--;
+	}
+
+	return (int)rx_state.left;
+}
+
+int qspi_read(void *i_buff, size_t count)
+{
+	int ret;
+
+	if (!i_buff)
+		return -ENULL;
+
+	if (!qspi_burst)
+		return qspi_read_by_byte(i_buff, count);
+
+	ret = qspi_read_start(i_buff, count);
+	if (ret)
+		return ret;
+
+	while (qspi_read_poll())
+		;
+
+	return 0;
+}
+
+void qspi_set_burst(bool enable)
+{
+	qspi_burst = enable;
+}
+
 int qspi_init(void)
 {
 	int ret;
 	qspi_regs_t *qspi_regs = qspi_get_regs();
 
-	ret = qspi_xip_disable();
+	ret = qspi_xip_set(QSPI_XIP_DISABLE);
 	if (ret)
 		return ret;
 
@@ -140,6 +278,7 @@ int qspi_init(void)
 
 	// allow qspi outputs
 	qspi_write_reg(&qspi_regs->ctrl_aux, QSPI_CTRL_AUX_QMODE_MASK, QSPI_MODE_NORMAL);
+	qspi_mode = QSPI_MODE_NORMAL;
 	// Enable full duplex mode
 	qspi_full_duplex_en(qspi_regs, QSPI_FULL_DUPLEX);
 	// Allowed control outputs from the register
@@ -155,6 +294,33 @@ int qspi_init(void)
 	return 0;
 }
 
+int qspi_set_mode(unsigned int mode)
+{
+	qspi_regs_t *qspi_regs = qspi_get_regs();
+
+	if (mode != QSPI_MODE_NORMAL && mode != QSPI_MODE_DUAL && mode != QSPI_MODE_QUAD)
+		return -EINVALIDPARAM;
+
+	if (mode == qspi_mode)
+		return 0;
+
+	qspi_write_reg(&qspi_regs->ctrl_aux, QSPI_CTRL_AUX_QMODE_MASK, mode);
+
+	// Only 1-wire mode is full duplex, in other modes IO0/IO1 change direction
+	qspi_full_duplex_en(qspi_regs,
+	                    (mode == QSPI_MODE_NORMAL) ? QSPI_FULL_DUPLEX : QSPI_HALF_DUPLEX);
+
+	// IO2/IO3 are WP#/HOLD# driven from GPO unless they carry quad data
+	if (mode == QSPI_MODE_QUAD)
+		qspi_write_reg(&qspi_regs->gpo_clr, QSPI_GPO_EN_MASK, 0xC);
+	else
+		qspi_write_reg(&qspi_regs->gpo_set, QSPI_GPO_EN_MASK, 0xC);
+
+	qspi_mode = mode;
+
+	return 0;
+}
+
 void qspi_ss_ctrl(bool enable)
 {
 	qspi_regs_t *qspi_regs = qspi_get_regs();
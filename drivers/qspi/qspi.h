@@ -83,6 +83,59 @@ typedef struct {
 
 int qspi_init(void);
 int qspi_write(const void *o_buff, size_t count);
+
+/**
+ * @brief Receive data, in burst mode TX FIFO is kept full and RX FIFO is drained by batches
+ *
+ * @param i_buff - Destination buffer
+ * @param count  - Number of bytes to read
+ *
+ * @return 0 on success, negative error code otherwise
+ */
 int qspi_read(void *i_buff, size_t count);
+
+/**
+ * @brief Enable or disable burst mode of qspi_read(), it is enabled by default.
+ *        Without burst mode each byte is sent and received separately.
+ *
+ * @param enable - Burst mode state
+ */
+void qspi_set_burst(bool enable);
+
+/**
+ * @brief Start split-phase reading, the data is received by qspi_read_poll() calls
+ *
+ * @param i_buff - Destination buffer, it must stay valid until qspi_read_poll() returns 0
+ * @param count  - Number of bytes to read
+ *
+ * @return 0 on success, negative error code otherwise
+ */
+int qspi_read_start(void *i_buff, size_t count);
+
+/**
+ * @brief Drain RX FIFO and refill TX FIFO without waiting for the flash
+ *
+ * @return Number of bytes which are not received yet, 0 when reading is finished
+ */
+int qspi_read_poll(void);
 void qspi_ss_ctrl(bool enable);
+
+/**
+ * @brief Set number of data lines for the following transfers
+ *
+ * @param mode - QSPI_MODE_NORMAL, QSPI_MODE_DUAL or QSPI_MODE_QUAD
+ *
+ * @return 0 on success, -EINVALIDPARAM for unknown mode
+ */
+int qspi_set_mode(unsigned int mode);
 int qspi_xfer(uint8_t *send_buf, int send_len, uint8_t *recv_buf, int recv_len);
+
+/**
+ * @brief Enable or disable QSPI0 XIP window. Register driven transfers are not allowed
+ *        while XIP is enabled.
+ *
+ * @param state - QSPI_XIP_ENABLE or QSPI_XIP_DISABLE
+ *
+ * @return 0 on success, -EINVALIDPARAM for unknown state, -ETIMEOUT if state is not changed
+ */
+int qspi_xip_set(unsigned int state);
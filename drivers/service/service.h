@@ -25,6 +25,7 @@
 #define BASE_ADDR_SERVICE_QLIC0     0xbfe00000
 #define BASE_ADDR_SERVICE_QSPI0     0xbff00000
 #define BASE_ADDR_SERVICE_QSPI0_XIP 0x00000000
+#define SERVICE_QSPI0_XIP_SIZE      0x1000000
 #define BASE_ADDR_SERVICE_MAILBOX0  0xbefd0000
 
 // SERVICE UCG1 Channels
@@ -0,0 +1,331 @@
+// SPDX-License-Identifier: MIT
+// Copyright 2025 RnD Center "ELVEES", JSC
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <libs/errors.h>
+#include <libs/utils-def.h>
+
+#include "sfdp.h"
+
+#define SFDP_SIGNATURE 0x50444653 // "SFDP"
+
+#define SFDP_HEADER_SIZE       8
+#define SFDP_PARAM_HEADER_SIZE 8
+
+#define SFDP_ID_BFPT  0xFF00 // Basic Flash Parameter Table
+#define SFDP_ID_4BAIT 0xFF84 // 4-byte Address Instruction Table
+
+#define SFDP_MAX_PARAM_HEADERS 16
+
+// Only first 16 DWORDs (JESD216B) are used
+#define BFPT_MIN_DWORDS 9
+#define BFPT_MAX_DWORDS 16
+
+#define FOURBAIT_DWORDS 2
+
+// BFPT DWORD 1
+#define BFPT_DW1_ADDR_BYTES GENMASK(18, 17)
+#define BFPT_DW1_READ_1_1_2 BIT(16)
+#define BFPT_DW1_READ_1_2_2 BIT(20)
+#define BFPT_DW1_READ_1_4_4 BIT(21)
+#define BFPT_DW1_READ_1_1_4 BIT(22)
+
+#define BFPT_DW1_ADDR_BYTES_3   0
+#define BFPT_DW1_ADDR_BYTES_3_4 1
+#define BFPT_DW1_ADDR_BYTES_4   2
+
+// BFPT DWORD 2
+#define BFPT_DW2_DENSITY_POW2 BIT(31)
+
+// Fast read parameters in DWORDs 3 and 4, each DWORD describes two protocols
+#define BFPT_READ_DUMMY  GENMASK(4, 0)
+#define BFPT_READ_MODE   GENMASK(7, 5)
+#define BFPT_READ_OPCODE GENMASK(15, 8)
+
+// BFPT DWORD 11
+#define BFPT_DW11_PAGE_SIZE GENMASK(7, 4)
+
+// BFPT DWORD 15
+#define BFPT_DW15_QER GENMASK(22, 20)
+
+// BFPT DWORD 16, Enter 4-Byte Addressing
+#define BFPT_DW16_EN4B       BIT(24)
+#define BFPT_DW16_WREN_EN4B  BIT(25)
+#define BFPT_DW16_4B_OPCODES BIT(29)
+#define BFPT_DW16_4B_ALWAYS  BIT(30)
+
+// 4BAIT DWORD 1
+#define FOURBAIT_DW1_READ       BIT(0)
+#define FOURBAIT_DW1_READ_1_1_2 BIT(2)
+#define FOURBAIT_DW1_READ_1_2_2 BIT(3)
+#define FOURBAIT_DW1_READ_1_1_4 BIT(4)
+#define FOURBAIT_DW1_READ_1_4_4 BIT(5)
+#define FOURBAIT_DW1_PP         BIT(6)
+#define FOURBAIT_DW1_ERASE(n)   BIT(9 + (n))
+
+#define CMD_4READ 0x13
+#define CMD_4PP   0x12
+
+struct sfdp_read_desc {
+	uint32_t dw1_flag;
+	uint32_t fourbait_flag;
+	uint8_t dword; // Index of DWORD with read parameters
+	uint8_t shift; // Offset of parameters in DWORD
+	uint8_t opcode_4b; // Standard 4-byte address opcode
+};
+
+static const struct sfdp_read_desc sfdp_read_descs[SFDP_READ_COUNT] = {
+	[SFDP_READ_1_1_2] = { BFPT_DW1_READ_1_1_2, FOURBAIT_DW1_READ_1_1_2, 3, 0, 0x3C },
+	[SFDP_READ_1_2_2] = { BFPT_DW1_READ_1_2_2, FOURBAIT_DW1_READ_1_2_2, 3, 16, 0xBC },
+	[SFDP_READ_1_1_4] = { BFPT_DW1_READ_1_1_4, FOURBAIT_DW1_READ_1_1_4, 2, 16, 0x6C },
+	[SFDP_READ_1_4_4] = { BFPT_DW1_READ_1_4_4, FOURBAIT_DW1_READ_1_4_4, 2, 0, 0xEC },
+};
+
+struct sfdp_table {
+	uint32_t addr;
+	uint8_t dwords;
+	uint8_t minor;
+};
+
+static uint32_t sfdp_le32(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static int sfdp_read_dwords(sfdp_read_func_t read, const struct sfdp_table *table, uint32_t *dw,
+                            int max)
+{
+	uint8_t buf[BFPT_MAX_DWORDS * 4];
+	int count = MIN((int)table->dwords, max);
+	int ret;
+
+	ret = read(table->addr, buf, count * 4);
+	if (ret)
+		return ret;
+
+	for (int i = 0; i < count; i++)
+		dw[i] = sfdp_le32(&buf[i * 4]);
+
+	return count;
+}
+
+// Standard opcodes of erase commands with 4-byte address
+static uint8_t sfdp_erase_opcode_4b(uint8_t opcode)
+{
+	switch (opcode) {
+	case 0x20:
+		return 0x21;
+	case 0x52:
+		return 0x5C;
+	case 0xD8:
+		return 0xDC;
+	default:
+		return 0;
+	}
+}
+
+static int sfdp_parse_bfpt(const uint32_t *dw, int dwords, sfdp_info_t *info)
+{
+	uint32_t density;
+	uint32_t addr4 = 0;
+
+	// Flashes larger than 4 GiB are not supported
+	density = dw[1] & ~BFPT_DW2_DENSITY_POW2;
+	if (dw[1] & BFPT_DW2_DENSITY_POW2) {
+		if (density < 3 || density > 34)
+			return -ENOTSUPPORTED;
+		info->size = 1U << (density - 3);
+	} else {
+		info->size = (density >> 3) + 1;
+	}
+
+	for (int i = 0; i < SFDP_READ_COUNT; i++) {
+		const struct sfdp_read_desc *desc = &sfdp_read_descs[i];
+		uint32_t params = dw[desc->dword] >> desc->shift;
+
+		if (!(dw[0] & desc->dw1_flag))
+			continue;
+
+		info->read[i].opcode = FIELD_GET(BFPT_READ_OPCODE, params);
+		info->read[i].mode_cycles = FIELD_GET(BFPT_READ_MODE, params);
+		info->read[i].dummy_cycles = FIELD_GET(BFPT_READ_DUMMY, params);
+	}
+
+	// Erase types are described by DWORDs 8 and 9, two types in each
+	for (int i = 0; i < SFDP_ERASE_TYPES; i++) {
+		uint32_t params = dw[7 + i / 2] >> ((i % 2) * 16);
+		uint8_t size_pow2 = params & 0xFF;
+
+		if (!size_pow2 || size_pow2 > 31)
+			continue;
+
+		info->erase[i].size = 1U << size_pow2;
+		info->erase[i].opcode = (params >> 8) & 0xFF;
+	}
+
+	info->page_size = 256;
+	if (dwords >= 11)
+		info->page_size = 1U << FIELD_GET(BFPT_DW11_PAGE_SIZE, dw[10]);
+
+	info->qe = SFDP_QE_UNKNOWN;
+	if (dwords >= 15)
+		info->qe = FIELD_GET(BFPT_DW15_QER, dw[14]);
+
+	if (dwords >= 16)
+		addr4 = dw[15];
+
+	switch (FIELD_GET(BFPT_DW1_ADDR_BYTES, dw[0])) {
+	case BFPT_DW1_ADDR_BYTES_3:
+		info->addr4 = SFDP_ADDR4_NONE;
+		break;
+	case BFPT_DW1_ADDR_BYTES_4:
+		info->addr4 = SFDP_ADDR4_ALWAYS;
+		break;
+	default:
+		// Prefer stateless 4-byte opcodes, they survive a warm reset of the SoC
+		if (addr4 & BFPT_DW16_4B_OPCODES)
+			info->addr4 = SFDP_ADDR4_OPCODES;
+		else if (addr4 & BFPT_DW16_EN4B)
+			info->addr4 = SFDP_ADDR4_EN4B;
+		else if (addr4 & BFPT_DW16_WREN_EN4B)
+			info->addr4 = SFDP_ADDR4_WREN_EN4B;
+		else if (addr4 & BFPT_DW16_4B_ALWAYS)
+			info->addr4 = SFDP_ADDR4_ALWAYS;
+		else
+			info->addr4 = SFDP_ADDR4_NONE;
+		break;
+	}
+
+	if (info->addr4 == SFDP_ADDR4_OPCODES) {
+		info->read_opcode_4b = CMD_4READ;
+		info->program_opcode_4b = CMD_4PP;
+		for (int i = 0; i < SFDP_READ_COUNT; i++)
+			if (info->read[i].opcode)
+				info->read[i].opcode_4b = sfdp_read_descs[i].opcode_4b;
+		for (int i = 0; i < SFDP_ERASE_TYPES; i++)
+			info->erase[i].opcode_4b = sfdp_erase_opcode_4b(info->erase[i].opcode);
+	}
+
+	return 0;
+}
+
+static void sfdp_parse_4bait(const uint32_t *dw, sfdp_info_t *info)
+{
+	// 4-byte opcodes are useless without basic read and program commands
+	if (!(dw[0] & FOURBAIT_DW1_READ) || !(dw[0] & FOURBAIT_DW1_PP))
+		return;
+
+	info->addr4 = SFDP_ADDR4_OPCODES;
+	info->read_opcode_4b = CMD_4READ;
+	info->program_opcode_4b = CMD_4PP;
+
+	for (int i = 0; i < SFDP_READ_COUNT; i++) {
+		info->read[i].opcode_4b = 0;
+		if (info->read[i].opcode && (dw[0] & sfdp_read_descs[i].fourbait_flag))
+			info->read[i].opcode_4b = sfdp_read_descs[i].opcode_4b;
+	}
+
+	for (int i = 0; i < SFDP_ERASE_TYPES; i++) {
+		info->erase[i].opcode_4b = 0;
+		if (info->erase[i].size && (dw[0] & FOURBAIT_DW1_ERASE(i)))
+			info->erase[i].opcode_4b = (dw[1] >> (i * 8)) & 0xFF;
+	}
+}
+
+// Unsupported erase types (with zero size) are moved to the end
+static uint64_t sfdp_erase_sort_key(const struct sfdp_erase_type *erase)
+{
+	return erase->size ? erase->size : UINT64_MAX;
+}
+
+static void sfdp_sort_erase_types(sfdp_info_t *info)
+{
+	for (int i = 1; i < SFDP_ERASE_TYPES; i++) {
+		struct sfdp_erase_type tmp = info->erase[i];
+		uint64_t key = sfdp_erase_sort_key(&tmp);
+		int j = i;
+
+		while (j > 0 && sfdp_erase_sort_key(&info->erase[j - 1]) > key) {
+			info->erase[j] = info->erase[j - 1];
+			j--;
+		}
+
+		info->erase[j] = tmp;
+	}
+}
+
+int sfdp_parse(sfdp_read_func_t read, sfdp_info_t *info)
+{
+	uint8_t buf[SFDP_PARAM_HEADER_SIZE];
+	uint32_t dw[BFPT_MAX_DWORDS];
+	struct sfdp_table bfpt = { 0 };
+	struct sfdp_table fourbait = { 0 };
+	int headers;
+	int ret;
+
+	if (!read || !info)
+		return -ENULL;
+
+	memset(info, 0, sizeof(*info));
+
+	ret = read(0, buf, SFDP_HEADER_SIZE);
+	if (ret)
+		return ret;
+
+	// Only major revision 1 is defined by JESD216
+	if (sfdp_le32(buf) != SFDP_SIGNATURE || buf[5] != 1)
+		return -ENOTSUPPORTED;
+
+	headers = MIN(buf[6] + 1, SFDP_MAX_PARAM_HEADERS);
+	for (int i = 0; i < headers; i++) {
+		struct sfdp_table table;
+		uint16_t id;
+
+		ret = read(SFDP_HEADER_SIZE + i * SFDP_PARAM_HEADER_SIZE, buf,
+		           SFDP_PARAM_HEADER_SIZE);
+		if (ret)
+			return ret;
+
+		id = (buf[7] << 8) | buf[0];
+		table.minor = buf[1];
+		table.dwords = buf[3];
+		table.addr = buf[4] | (buf[5] << 8) | (buf[6] << 16);
+
+		// Parameter tables with unknown major revision must be ignored
+		if (buf[2] != 1)
+			continue;
+
+		if (id == SFDP_ID_BFPT && (!bfpt.dwords || table.minor > bfpt.minor))
+			bfpt = table;
+		else if (id == SFDP_ID_4BAIT)
+			fourbait = table;
+	}
+
+	if (bfpt.dwords < BFPT_MIN_DWORDS)
+		return -EINVALIDDATA;
+
+	memset(dw, 0, sizeof(dw));
+	ret = sfdp_read_dwords(read, &bfpt, dw, BFPT_MAX_DWORDS);
+	if (ret < 0)
+		return ret;
+
+	ret = sfdp_parse_bfpt(dw, ret, info);
+	if (ret)
+		return ret;
+
+	if (fourbait.dwords >= FOURBAIT_DWORDS && info->addr4 != SFDP_ADDR4_NONE) {
+		ret = sfdp_read_dwords(read, &fourbait, dw, FOURBAIT_DWORDS);
+		if (ret < 0)
+			return ret;
+
+		sfdp_parse_4bait(dw, info);
+	}
+
+	sfdp_sort_erase_types(info);
+
+	return 0;
+}
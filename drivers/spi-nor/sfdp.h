@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: MIT
+// Copyright 2025 RnD Center "ELVEES", JSC
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#define SFDP_ERASE_TYPES 4
+
+// Fast read protocols described by Basic Flash Parameter Table
+enum sfdp_read_proto {
+	SFDP_READ_1_1_2,
+	SFDP_READ_1_2_2,
+	SFDP_READ_1_1_4,
+	SFDP_READ_1_4_4,
+	SFDP_READ_COUNT,
+};
+
+// How the flash is switched to 4-byte addressing
+enum sfdp_addr4 {
+	SFDP_ADDR4_NONE, // Only 3-byte addressing is supported
+	SFDP_ADDR4_OPCODES, // Dedicated 4-byte address opcodes
+	SFDP_ADDR4_EN4B, // Enter 4-byte mode by B7h command
+	SFDP_ADDR4_WREN_EN4B, // Enter 4-byte mode by 06h and B7h commands
+	SFDP_ADDR4_ALWAYS, // Flash always operates in 4-byte mode
+};
+
+// Quad Enable Requirements (JESD216B, BFPT DWORD 15 bits 22:20)
+enum sfdp_qe {
+	SFDP_QE_NONE = 0, // No QE bit
+	SFDP_QE_SR2_BIT1 = 1, // SR2 bit 1, written together with SR1 by 01h
+	SFDP_QE_SR1_BIT6 = 2, // SR1 bit 6, written by 01h
+	SFDP_QE_SR2_BIT7 = 3, // SR2 bit 7, written by 3Eh
+	SFDP_QE_SR2_BIT1_NO_CLR = 4, // SR2 bit 1, written together with SR1 by 01h
+	SFDP_QE_SR2_BIT1_RD35 = 5, // SR2 bit 1, read by 35h, written together with SR1 by 01h
+	SFDP_QE_SR2_BIT1_WR31 = 6, // SR2 bit 1, read by 35h, written by 31h
+	SFDP_QE_UNKNOWN = 0xFF, // BFPT is too old to describe QE bit
+};
+
+struct sfdp_read_op {
+	uint8_t opcode; // 0 if protocol is not supported
+	uint8_t opcode_4b; // 0 if protocol is not supported with 4-byte address
+	uint8_t mode_cycles;
+	uint8_t dummy_cycles;
+};
+
+struct sfdp_erase_type {
+	uint32_t size; // 0 if erase type is not supported
+	uint8_t opcode;
+	uint8_t opcode_4b; // 0 if erase type is not supported with 4-byte address
+};
+
+typedef struct {
+	uint32_t size;
+	uint32_t page_size;
+	enum sfdp_addr4 addr4;
+	enum sfdp_qe qe;
+	uint8_t read_opcode_4b; // 0x13 or 0 if it isn't supported
+	uint8_t program_opcode_4b; // 0x12 or 0 if it isn't supported
+	struct sfdp_read_op read[SFDP_READ_COUNT];
+	struct sfdp_erase_type erase[SFDP_ERASE_TYPES]; // Sorted by size from small to large
+} sfdp_info_t;
+
+/**
+ * @brief Function which reads SFDP area of flash memory
+ *
+ * @param address - SFDP address
+ * @param buffer  - Destination buffer
+ * @param size    - Number of bytes to read
+ *
+ * @return 0 on success or negative error code
+ */
+typedef int (*sfdp_read_func_t)(uint32_t address, void *buffer, uint32_t size);
+
+/**
+ * @brief Parse Serial Flash Discoverable Parameters (JESD216)
+ *
+ * Basic Flash Parameter Table is mandatory, 4-byte Address Instruction Table is used if present.
+ *
+ * @param read - Function which reads SFDP area
+ * @param info - Parsed parameters
+ *
+ * @return 0 on success, -ENOTSUPPORTED if flash has no SFDP or negative error code
+ */
+int sfdp_parse(sfdp_read_func_t read, sfdp_info_t *info);
+
+#ifdef __cplusplus
+}
+#endif
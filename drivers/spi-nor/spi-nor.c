@@ -5,14 +5,23 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 #include <drivers/qspi/qspi.h>
+#include <drivers/service/service.h>
 #include <libs/errors.h>
 #include <libs/log.h>
 #include <libs/utils-def.h>
 
+#include "sfdp.h"
 #include "spi-nor.h"
 
+#ifdef SPI_NOR_BENCHMARK_ENABLE
+#include <stdlib.h>
+
+#include <drivers/timer/timer.h>
+#endif
+
 #define CMD_WREN       0x06 // write enable command
 #define CMD_WRDI       0x04 // write disable command
 #define CMD_RDSR1      0x05 // read status register-1 command
@@ -25,18 +34,36 @@
 #define CMD_FAST_READ  0x0B // fast read command (3- or 4-byte address)
 #define CMD_4FAST_READ 0x0C // fast read command (4-byte address)
 #define CMD_4READ      0x13 // read command (4-byte address)
+#define CMD_DUAL_READ     0x3B // dual output read command 1-1-2 (3- or 4-byte address)
+#define CMD_4DUAL_READ    0x3C // dual output read command 1-1-2 (4-byte address)
+#define CMD_DUAL_IO_READ  0xBB // dual I/O read command 1-2-2 (3- or 4-byte address)
+#define CMD_4DUAL_IO_READ 0xBC // dual I/O read command 1-2-2 (4-byte address)
+#define CMD_QUAD_READ     0x6B // quad output read command 1-1-4 (3- or 4-byte address)
+#define CMD_4QUAD_READ    0x6C // quad output read command 1-1-4 (4-byte address)
+#define CMD_QUAD_IO_READ  0xEB // quad I/O read command 1-4-4 (3- or 4-byte address)
+#define CMD_4QUAD_IO_READ 0xEC // quad I/O read command 1-4-4 (4-byte address)
+#define CMD_WRSR       0x01 // write status register-1 (and configuration register-1) command
+#define CMD_WRSR2      0x31 // write status register-2 command
 #define CMD_BULK_ERASE 0x60 // bulk erase command
 #define CMD_RDCR1      0x35 // read configuration register-1 command
 #define CMD_CLSR1      0x30 // clear status register-1 command - Erase/Program Fail Reset
+#define CMD_RDSFDP     0x5A // read Serial Flash Discoverable Parameters command
+#define CMD_EN4B       0xB7 // enter 4-byte address mode command
+#define CMD_EX4B       0xE9 // exit 4-byte address mode command
 
 // Status Register 1 (SR1)
 #define SR1_WIP  BIT(0)
 #define SR1_WEL  BIT(1)
+#define SR1_QE   BIT(6) // Quad Enable on Macronix and ISSI flashes
 #define SR1_SRWD BIT(7)
 
 // Configuration Register 1 (CR1)
+#define CR1_QUAD   BIT(1)
 #define CR1_TBPARM BIT(2)
 
+// Status Register 2 (SR2), it is read by CMD_RDCR1 on Winbond flashes
+#define SR2_QE BIT(1)
+
 // CR1 register has on Cypress flashes
 #define FLAG_HAS_CR1 BIT(0)
 
@@ -50,6 +77,35 @@
 #define FLAG_4KSECT_BEGIN BIT(3)
 #define FLAG_4KSECT_END   BIT(4)
 
+// Supported multi I/O read commands
+#define FLAG_READ_1_1_2 BIT(5)
+#define FLAG_READ_1_2_2 BIT(6)
+#define FLAG_READ_1_1_4 BIT(7)
+#define FLAG_READ_1_4_4 BIT(8)
+
+#define FLAG_READ_MULTI_IO (FLAG_READ_1_1_2 | FLAG_READ_1_2_2 | FLAG_READ_1_1_4 | FLAG_READ_1_4_4)
+
+// Quad Enable is SR2 bit 1 written by CMD_WRSR2 (Winbond)
+#define FLAG_QE_SR2 BIT(9)
+
+// Quad Enable is CR1 bit 1 written together with SR1 by CMD_WRSR (Cypress)
+#define FLAG_QE_CR1 BIT(10)
+
+// Quad Enable is SR1 bit 6 written by CMD_WRSR (Macronix)
+#define FLAG_QE_SR1 BIT(11)
+
+// Flash parameters are discovered by SFDP, read commands are taken from spi_nor_sfdp_read_ops
+#define FLAG_SFDP BIT(12)
+
+// Flash is switched to 4-byte address mode, so it can't be accessed through 3-byte XIP window
+#define FLAG_4B_MODE BIT(13)
+
+// 4-byte address mode is entered by CMD_EN4B, it's left by spi_nor_deinit()
+#define FLAG_4B_EN4B BIT(14)
+
+// CMD_EN4B and CMD_EX4B must be preceded by Write Enable
+#define FLAG_4B_WREN BIT(15)
+
 #define KiB 1024
 #define MiB (1024 * KiB)
 
@@ -65,29 +121,59 @@ struct spi_nor_id {
 	uint32_t flags;
 };
 
+#define FLAGS_CYPRESS (FLAG_HAS_CR1 | FLAG_HAS_ERR_BITS | FLAG_READ_MULTI_IO | FLAG_QE_CR1)
+#define FLAGS_WINBOND (FLAG_READ_MULTI_IO | FLAG_QE_SR2)
+
 static struct spi_nor_id spi_nor_ids[] = {
 	{ "M25P32", 0x202016, 0, 4 * MiB, 64 * KiB, 256, 0 },
-	{ "S25FL128S", 0x012018, 0x0080, 16 * MiB, 256 * KiB, 256,
-	  FLAG_HAS_CR1 | FLAG_HAS_ERR_BITS },
+	{ "S25FL128S", 0x012018, 0x0080, 16 * MiB, 256 * KiB, 256, FLAGS_CYPRESS },
 	{ "S25FL128S", 0x012018, 0x0180, 16 * MiB, 64 * KiB, 256,
-	  FLAG_HAS_CR1 | FLAG_HAS_ERR_BITS | FLAG_DIFFERENT_SECTORS },
-	{ "S25FL256S", 0x010219, 0x0080, 32 * MiB, 256 * KiB, 256,
-	  FLAG_HAS_CR1 | FLAG_HAS_ERR_BITS },
+	  FLAGS_CYPRESS | FLAG_DIFFERENT_SECTORS },
+	{ "S25FL256S", 0x010219, 0x0080, 32 * MiB, 256 * KiB, 256, FLAGS_CYPRESS },
 	{ "S25FL256S", 0x010219, 0x0180, 32 * MiB, 64 * KiB, 256,
-	  FLAG_HAS_CR1 | FLAG_HAS_ERR_BITS | FLAG_DIFFERENT_SECTORS },
-	{ "W25Q16JW-IM", 0xEF8015, 0, 2 * MiB, 64 * KiB, 256, 0 },
-	{ "W25Q16JW-IQ/JQ", 0xEF6015, 0, 2 * MiB, 64 * KiB, 256, 0 },
-	{ "W25Q32", 0xEF4016, 0, 4 * MiB, 64 * KiB, 256, 0 },
-	{ "W25Q128JV-IN/IQ/JQ", 0xEF4018, 0, 16 * MiB, 64 * KiB, 256, 0 },
-	{ "W25Q128JV-IM/JM", 0xEF7018, 0, 16 * MiB, 64 * KiB, 256, 0 },
-	{ "W25Q128FW/JW", 0xEF6018, 0, 16 * MiB, 64 * KiB, 256, 0 },
-	{ "W25Q256JV-IQ/IN/JQ", 0xEF4019, 0, 32 * MiB, 64 * KiB, 256, 0 },
-	{ "W25Q256JV-IM/JM", 0xEF7019, 0, 32 * MiB, 64 * KiB, 256, 0 },
-	{ "W25Q256JW", 0xEF6019, 0, 32 * MiB, 64 * KiB, 256, 0 },
-	{ "W25Q256JW-IM", 0xEF8019, 0, 32 * MiB, 64 * KiB, 256, 0 },
+	  FLAGS_CYPRESS | FLAG_DIFFERENT_SECTORS },
+	{ "W25Q16JW-IM", 0xEF8015, 0, 2 * MiB, 64 * KiB, 256, FLAGS_WINBOND },
+	{ "W25Q16JW-IQ/JQ", 0xEF6015, 0, 2 * MiB, 64 * KiB, 256, FLAGS_WINBOND },
+	{ "W25Q32", 0xEF4016, 0, 4 * MiB, 64 * KiB, 256, FLAGS_WINBOND },
+	{ "W25Q128JV-IN/IQ/JQ", 0xEF4018, 0, 16 * MiB, 64 * KiB, 256, FLAGS_WINBOND },
+	{ "W25Q128JV-IM/JM", 0xEF7018, 0, 16 * MiB, 64 * KiB, 256, FLAGS_WINBOND },
+	{ "W25Q128FW/JW", 0xEF6018, 0, 16 * MiB, 64 * KiB, 256, FLAGS_WINBOND },
+	{ "W25Q256JV-IQ/IN/JQ", 0xEF4019, 0, 32 * MiB, 64 * KiB, 256, FLAGS_WINBOND },
+	{ "W25Q256JV-IM/JM", 0xEF7019, 0, 32 * MiB, 64 * KiB, 256, FLAGS_WINBOND },
+	{ "W25Q256JW", 0xEF6019, 0, 32 * MiB, 64 * KiB, 256, FLAGS_WINBOND },
+	{ "W25Q256JW-IM", 0xEF8019, 0, 32 * MiB, 64 * KiB, 256, FLAGS_WINBOND },
+};
+
+struct spi_nor_read_op {
+	uint32_t flag;
+	uint8_t opcode;
+	uint8_t opcode_4b;
+	uint8_t addr_mode; // QSPI_MODE_* for address and mode bits
+	uint8_t data_mode; // QSPI_MODE_* for dummy cycles and data
+	uint8_t mode_cycles;
+	uint8_t dummy_cycles;
 };
 
+// Sorted from the fastest to the slowest one, the last one is supported by all flashes
+static const struct spi_nor_read_op spi_nor_read_ops[] = {
+	{ FLAG_READ_1_4_4, CMD_QUAD_IO_READ, CMD_4QUAD_IO_READ,
+	  QSPI_MODE_QUAD, QSPI_MODE_QUAD, 2, 4 },
+	{ FLAG_READ_1_1_4, CMD_QUAD_READ, CMD_4QUAD_READ,
+	  QSPI_MODE_NORMAL, QSPI_MODE_QUAD, 0, 8 },
+	{ FLAG_READ_1_2_2, CMD_DUAL_IO_READ, CMD_4DUAL_IO_READ,
+	  QSPI_MODE_DUAL, QSPI_MODE_DUAL, 4, 0 },
+	{ FLAG_READ_1_1_2, CMD_DUAL_READ, CMD_4DUAL_READ,
+	  QSPI_MODE_NORMAL, QSPI_MODE_DUAL, 0, 8 },
+	{ 0, CMD_READ, CMD_4READ,
+	  QSPI_MODE_NORMAL, QSPI_MODE_NORMAL, 0, 0 },
+};
+
+// Copy of spi_nor_read_ops with opcodes and cycles discovered by SFDP
+static struct spi_nor_read_op spi_nor_sfdp_read_ops[ARRAY_SIZE(spi_nor_read_ops)];
+
 static nor_flash_t nor_flash;
+static bool read_pending;
+static bool xip_enabled;
 
 static int __spi_nor_jedec_id(uint8_t *jedec_id, uint32_t size)
 {
@@ -161,6 +247,123 @@ static int spi_nor_read_wip(uint32_t timeout)
 	return 0;
 }
 
+static int spi_nor_mode_width(uint8_t mode)
+{
+	switch (mode) {
+	case QSPI_MODE_QUAD:
+		return 4;
+	case QSPI_MODE_DUAL:
+		return 2;
+	default:
+		return 1;
+	}
+}
+
+#ifdef SPI_NOR_MULTI_IO_ENABLE
+static int spi_nor_read_qe_reg(uint8_t *reg)
+{
+	if (nor_flash.flags & FLAG_QE_SR1)
+		return spi_nor_read_status1(reg);
+
+	return spi_nor_read_cr1(reg);
+}
+
+static int spi_nor_quad_enable(void)
+{
+	int ret;
+	uint8_t cmd[3];
+	uint8_t sr1 = 0;
+	uint8_t reg;
+	uint8_t qe;
+	int len;
+
+	if (nor_flash.flags & FLAG_QE_SR2) {
+		qe = SR2_QE;
+		len = 2;
+	} else if (nor_flash.flags & FLAG_QE_CR1) {
+		qe = CR1_QUAD;
+		len = 3;
+	} else if (nor_flash.flags & FLAG_QE_SR1) {
+		qe = SR1_QE;
+		len = 2;
+	} else {
+		// Flash has no QE bit
+		return 0;
+	}
+
+	ret = spi_nor_read_qe_reg(&reg);
+	if (ret)
+		return ret;
+
+	// QE bit is non-volatile, don't rewrite it if it's already set
+	if (reg & qe)
+		return 0;
+
+	if (len == 3) {
+		ret = spi_nor_read_status1(&sr1);
+		if (ret)
+			return ret;
+
+		cmd[0] = CMD_WRSR;
+		cmd[1] = sr1;
+		cmd[2] = reg | qe;
+	} else {
+		cmd[0] = (nor_flash.flags & FLAG_QE_SR1) ? CMD_WRSR : CMD_WRSR2;
+		cmd[1] = reg | qe;
+	}
+
+	ret = spi_nor_write_enable();
+	if (ret)
+		return ret;
+
+	ret = qspi_xfer(cmd, len, NULL, 0);
+	if (ret)
+		return ret;
+
+	ret = spi_nor_read_wip(UINT16_MAX);
+	if (ret)
+		return ret;
+
+	ret = spi_nor_read_qe_reg(&reg);
+	if (ret)
+		return ret;
+
+	return (reg & qe) ? 0 : -EINVALIDSTATE;
+}
+#endif
+
+static void spi_nor_select_read_op(void)
+{
+	const struct spi_nor_read_op *ops;
+	const struct spi_nor_read_op *op;
+
+	ops = (nor_flash.flags & FLAG_SFDP) ? spi_nor_sfdp_read_ops : spi_nor_read_ops;
+	op = &ops[ARRAY_SIZE(spi_nor_read_ops) - 1];
+
+#ifdef SPI_NOR_MULTI_IO_ENABLE
+	for (int i = 0; i < ARRAY_SIZE(spi_nor_read_ops) - 1; i++) {
+		if (!(nor_flash.flags & ops[i].flag))
+			continue;
+
+		if (ops[i].data_mode == QSPI_MODE_QUAD && spi_nor_quad_enable()) {
+			WARN("Failed to enable SPI NOR quad mode\n");
+			continue;
+		}
+
+		op = &ops[i];
+		break;
+	}
+#endif
+
+	nor_flash.read_opcode = (nor_flash.addr_bytes == 4) ? op->opcode_4b : op->opcode;
+	nor_flash.read_addr_mode = op->addr_mode;
+	nor_flash.read_data_mode = op->data_mode;
+	nor_flash.read_mode_cycles = op->mode_cycles;
+	nor_flash.read_dummy_cycles = op->dummy_cycles;
+
+	INFO("SPI NOR read command: 0x%02x\n", nor_flash.read_opcode);
+}
+
 static int spi_nor_erase_sector(uint32_t addr, uint32_t sector_count)
 {
 	int ret = -EINVALIDSTATE;
@@ -174,15 +377,14 @@ static int spi_nor_erase_sector(uint32_t addr, uint32_t sector_count)
 	}
 
 	addr_bytes = nor_flash.addr_bytes;
+	cmd[0] = nor_flash.erase_opcode;
 	for (uint32_t i = 0; i < sector_count; i++) {
 		if (addr_bytes == 4) {
-			cmd[0] = CMD_4SE;
 			cmd[1] = (uint8_t)(addr >> 24);
 			cmd[2] = (uint8_t)(addr >> 16);
 			cmd[3] = (uint8_t)(addr >> 8);
 			cmd[4] = (uint8_t)(addr >> 0);
 		} else {
-			cmd[0] = CMD_SE;
 			cmd[1] = (uint8_t)(addr >> 16);
 			cmd[2] = (uint8_t)(addr >> 8);
 			cmd[3] = (uint8_t)(addr >> 0);
@@ -247,14 +449,13 @@ static int spi_nor_write_page(uint8_t *buff, uint32_t addr, uint32_t page_size)
 	if (!buff)
 		return -ENULL;
 
+	cmd[0] = nor_flash.program_opcode;
 	if (nor_flash.addr_bytes == 4) {
-		cmd[0] = CMD_4PP;
 		cmd[1] = (uint8_t)(addr >> 24);
 		cmd[2] = (uint8_t)(addr >> 16);
 		cmd[3] = (uint8_t)(addr >> 8);
 		cmd[4] = (uint8_t)(addr);
 	} else {
-		cmd[0] = CMD_PP;
 		cmd[1] = (uint8_t)(addr >> 16);
 		cmd[2] = (uint8_t)(addr >> 8);
 		cmd[3] = (uint8_t)(addr);
@@ -289,9 +490,186 @@ static int spi_nor_write_page(uint8_t *buff, uint32_t addr, uint32_t page_size)
 	return 0;
 }
 
+static int spi_nor_read_sfdp(uint32_t address, void *buffer, uint32_t size)
+{
+	uint8_t cmd[5];
+
+	cmd[0] = CMD_RDSFDP;
+	cmd[1] = (uint8_t)(address >> 16);
+	cmd[2] = (uint8_t)(address >> 8);
+	cmd[3] = (uint8_t)(address);
+	cmd[4] = 0; // 8 dummy cycles
+
+	return qspi_xfer(cmd, sizeof(cmd), buffer, size);
+}
+
+static int spi_nor_addr_mode_set(uint8_t cmd, bool wren)
+{
+	int ret;
+
+	if (wren) {
+		ret = spi_nor_write_enable();
+		if (ret)
+			return ret;
+	}
+
+	ret = qspi_xfer(&cmd, 1, NULL, 0);
+	if (ret)
+		return ret;
+
+	return wren ? spi_nor_write_disable() : 0;
+}
+
+static void spi_nor_apply_sfdp_read_ops(const sfdp_info_t *sfdp, bool opcodes_4b)
+{
+	static const uint32_t proto_flags[SFDP_READ_COUNT] = {
+		[SFDP_READ_1_1_2] = FLAG_READ_1_1_2,
+		[SFDP_READ_1_2_2] = FLAG_READ_1_2_2,
+		[SFDP_READ_1_1_4] = FLAG_READ_1_1_4,
+		[SFDP_READ_1_4_4] = FLAG_READ_1_4_4,
+	};
+	struct spi_nor_read_op *op = &spi_nor_sfdp_read_ops[ARRAY_SIZE(spi_nor_read_ops) - 1];
+	bool quad = true;
+
+	memcpy(spi_nor_sfdp_read_ops, spi_nor_read_ops, sizeof(spi_nor_read_ops));
+
+	op->opcode = opcodes_4b ? sfdp->read_opcode_4b : CMD_READ;
+	op->opcode_4b = op->opcode;
+
+	switch (sfdp->qe) {
+	case SFDP_QE_NONE:
+		break;
+	case SFDP_QE_SR2_BIT1:
+	case SFDP_QE_SR2_BIT1_NO_CLR:
+	case SFDP_QE_SR2_BIT1_RD35:
+		nor_flash.flags |= FLAG_QE_CR1;
+		break;
+	case SFDP_QE_SR1_BIT6:
+		nor_flash.flags |= FLAG_QE_SR1;
+		break;
+	case SFDP_QE_SR2_BIT1_WR31:
+		nor_flash.flags |= FLAG_QE_SR2;
+		break;
+	default:
+		quad = false;
+		break;
+	}
+
+	for (int i = 0; i < SFDP_READ_COUNT; i++) {
+		const struct sfdp_read_op *sfdp_op = &sfdp->read[i];
+		uint8_t opcode = opcodes_4b ? sfdp_op->opcode_4b : sfdp_op->opcode;
+		uint8_t mode_cycles = sfdp_op->mode_cycles;
+		uint8_t dummy_cycles = sfdp_op->dummy_cycles;
+
+		op = NULL;
+		for (int j = 0; j < ARRAY_SIZE(spi_nor_read_ops) - 1; j++)
+			if (spi_nor_sfdp_read_ops[j].flag == proto_flags[i])
+				op = &spi_nor_sfdp_read_ops[j];
+
+		if (!op || !opcode || (op->data_mode == QSPI_MODE_QUAD && !quad))
+			continue;
+
+		// Some flashes report a part of mode clocks as dummy ones, but QSPI controller
+		// transfers whole bytes. Dummy cycles are filled by mode bits in this case.
+		if (op->addr_mode == op->data_mode &&
+		    (mode_cycles * spi_nor_mode_width(op->addr_mode)) % 8) {
+			mode_cycles += dummy_cycles;
+			dummy_cycles = 0;
+		}
+
+		if ((mode_cycles * spi_nor_mode_width(op->addr_mode)) % 8 ||
+		    (dummy_cycles * spi_nor_mode_width(op->data_mode)) % 8)
+			continue;
+
+		op->opcode = opcode;
+		op->opcode_4b = opcode;
+		op->mode_cycles = mode_cycles;
+		op->dummy_cycles = dummy_cycles;
+		nor_flash.flags |= op->flag;
+	}
+}
+
+static int spi_nor_apply_sfdp(const sfdp_info_t *sfdp)
+{
+	bool opcodes_4b = false;
+	int ret;
+
+	nor_flash.name = "SFDP";
+	nor_flash.size_in_bytes = sfdp->size;
+	nor_flash.page_size = sfdp->page_size;
+	nor_flash.addr_bytes = 3;
+	nor_flash.flags = FLAG_SFDP;
+
+	if (sfdp->size > 16 * MiB || sfdp->addr4 == SFDP_ADDR4_ALWAYS) {
+		nor_flash.addr_bytes = 4;
+		switch (sfdp->addr4) {
+		case SFDP_ADDR4_OPCODES:
+			opcodes_4b = true;
+			break;
+		case SFDP_ADDR4_EN4B:
+		case SFDP_ADDR4_WREN_EN4B:
+			// Stateful mode is the last resort, SFDP parser prefers 4-byte opcodes
+			if (sfdp->addr4 == SFDP_ADDR4_WREN_EN4B)
+				nor_flash.flags |= FLAG_4B_WREN;
+			ret = spi_nor_addr_mode_set(CMD_EN4B, nor_flash.flags & FLAG_4B_WREN);
+			if (ret)
+				return ret;
+			nor_flash.flags |= FLAG_4B_MODE | FLAG_4B_EN4B;
+			break;
+		case SFDP_ADDR4_ALWAYS:
+			nor_flash.flags |= FLAG_4B_MODE;
+			break;
+		default:
+			WARN("SPI NOR doesn't support 4-byte address, only 16 MiB is accessible\n");
+			nor_flash.size_in_bytes = 16 * MiB;
+			nor_flash.addr_bytes = 3;
+			break;
+		}
+	}
+
+	nor_flash.program_opcode = opcodes_4b ? sfdp->program_opcode_4b : CMD_PP;
+
+	// The largest erase type is used for sector erase
+	nor_flash.sector_size = 0;
+	for (int i = 0; i < SFDP_ERASE_TYPES; i++) {
+		uint8_t opcode = opcodes_4b ? sfdp->erase[i].opcode_4b : sfdp->erase[i].opcode;
+
+		nor_flash.erase_types[i].size = opcode ? sfdp->erase[i].size : 0;
+		nor_flash.erase_types[i].opcode = opcode;
+		if (opcode && sfdp->erase[i].size > nor_flash.sector_size) {
+			nor_flash.sector_size = sfdp->erase[i].size;
+			nor_flash.erase_opcode = opcode;
+		}
+	}
+
+	if (!nor_flash.sector_size || !nor_flash.page_size || !nor_flash.size_in_bytes)
+		return -EINVALIDDATA;
+
+	spi_nor_apply_sfdp_read_ops(sfdp, opcodes_4b);
+
+	return 0;
+}
+
+static void spi_nor_apply_id(const struct spi_nor_id *spi_nor_id)
+{
+	nor_flash.name = spi_nor_id->name;
+	nor_flash.size_in_bytes = spi_nor_id->size;
+	nor_flash.page_size = spi_nor_id->page_size;
+	nor_flash.sector_size = spi_nor_id->sector_size;
+	nor_flash.addr_bytes = spi_nor_id->size > 0x1000000 ? 4 : 3;
+	nor_flash.flags = spi_nor_id->flags;
+	nor_flash.program_opcode = (nor_flash.addr_bytes == 4) ? CMD_4PP : CMD_PP;
+	nor_flash.erase_opcode = (nor_flash.addr_bytes == 4) ? CMD_4SE : CMD_SE;
+
+	memset(nor_flash.erase_types, 0, sizeof(nor_flash.erase_types));
+	nor_flash.erase_types[0].size = nor_flash.sector_size;
+	nor_flash.erase_types[0].opcode = nor_flash.erase_opcode;
+}
+
 static int __spi_nor_init(void)
 {
 	struct spi_nor_id *spi_nor_id = NULL;
+	sfdp_info_t sfdp;
 	int ret;
 	uint32_t id;
 	uint16_t id_ext;
@@ -315,15 +693,23 @@ static int __spi_nor_init(void)
 	INFO("SPI NOR ID: 0x%02x 0x%02x 0x%02x 0x%02x 0x%02x 0x%02x (%s)\n", jedecid[0], jedecid[1],
 	     jedecid[2], jedecid[3], jedecid[4], jedecid[5],
 	     spi_nor_id ? spi_nor_id->name : "unknown");
+
+	// Known flashes are described by spi_nor_ids, SFDP is used for other ones
 	if (spi_nor_id) {
-		nor_flash.name = spi_nor_id->name;
-		nor_flash.size_in_bytes = spi_nor_id->size;
-		nor_flash.page_size = spi_nor_id->page_size;
-		nor_flash.sector_size = spi_nor_id->sector_size;
-		nor_flash.addr_bytes = spi_nor_id->size > 0x1000000 ? 4 : 3;
-		nor_flash.flags = spi_nor_id->flags;
+		spi_nor_apply_id(spi_nor_id);
 	} else {
-		return -ENOTSUPPORTED;
+		ret = sfdp_parse(spi_nor_read_sfdp, &sfdp);
+		if (ret) {
+			ERROR("SPI NOR SFDP parsing failed. Code: %d\n", ret);
+			return -ENOTSUPPORTED;
+		}
+
+		ret = spi_nor_apply_sfdp(&sfdp);
+		if (ret)
+			return ret;
+
+		INFO("SPI NOR SFDP: size %lu, page %lu, sector %lu\n", nor_flash.size_in_bytes,
+		     nor_flash.page_size, nor_flash.sector_size);
 	}
 
 	if ((nor_flash.flags & (FLAG_HAS_CR1 | FLAG_DIFFERENT_SECTORS)) ==
@@ -334,6 +720,8 @@ static int __spi_nor_init(void)
 		nor_flash.flags |= (cr1 & CR1_TBPARM) ? FLAG_4KSECT_END : FLAG_4KSECT_BEGIN;
 	}
 
+	spi_nor_select_read_op();
+
 	return 0;
 }
 
@@ -341,6 +729,10 @@ int spi_nor_init(void)
 {
 	int ret;
 
+	// qspi_init() disables XIP
+	xip_enabled = false;
+	read_pending = false;
+
 	ret = qspi_init();
 	if (ret) {
 		ERROR("qspi init failed. Code : %d\n", ret);
@@ -362,6 +754,44 @@ int spi_nor_init(void)
 	return 0;
 }
 
+int spi_nor_deinit(void)
+{
+	int ret;
+
+	if (read_pending)
+		return -EINVALIDSTATE;
+
+	ret = spi_nor_xip_unmap();
+	if (ret)
+		return ret;
+
+	// Next boot stages and BootROM use 3-byte address
+	if (nor_flash.flags & FLAG_4B_EN4B) {
+		ret = spi_nor_addr_mode_set(CMD_EX4B, nor_flash.flags & FLAG_4B_WREN);
+		if (ret)
+			return ret;
+		nor_flash.flags &= ~(FLAG_4B_MODE | FLAG_4B_EN4B);
+	}
+
+	return 0;
+}
+
+int spi_nor_xip_unmap(void)
+{
+	int ret;
+
+	if (!xip_enabled)
+		return 0;
+
+	ret = qspi_xip_set(QSPI_XIP_DISABLE);
+	if (ret)
+		return ret;
+
+	xip_enabled = false;
+
+	return 0;
+}
+
 int spi_nor_write(const void *buffer, uint32_t address, uint32_t size)
 {
 	int ret;
@@ -377,6 +807,10 @@ int spi_nor_write(const void *buffer, uint32_t address, uint32_t size)
 	if ((address + size) > nor_flash.size_in_bytes)
 		return -EINVALIDPARAM;
 
+	ret = spi_nor_xip_unmap();
+	if (ret)
+		return ret;
+
 	if (page_offset) {
 		int write_on_this_page = nor_flash.page_size - page_offset;
 		if (write_on_this_page > size)
@@ -410,33 +844,137 @@ int spi_nor_write(const void *buffer, uint32_t address, uint32_t size)
 	return 0;
 }
 
+static void spi_nor_read_end(void)
+{
+	// Toggle SS pin to end transmission
+	qspi_ss_ctrl(false);
+	qspi_set_mode(QSPI_MODE_NORMAL);
+}
+
+// Send read command, address, mode bits and dummy cycles
+static int spi_nor_read_begin(uint32_t address)
+{
+	int ret;
+	uint8_t cmd[8];
+	uint8_t dummy[16];
+	int len = 1;
+	int addr_width = spi_nor_mode_width(nor_flash.read_addr_mode);
+	int data_width = spi_nor_mode_width(nor_flash.read_data_mode);
+	int mode_len = nor_flash.read_mode_cycles * addr_width / 8;
+	int dummy_len = nor_flash.read_dummy_cycles * data_width / 8;
+
+	cmd[0] = nor_flash.read_opcode;
+	if (nor_flash.addr_bytes == 4)
+		cmd[len++] = (uint8_t)(address >> 24);
+	cmd[len++] = (uint8_t)(address >> 16);
+	cmd[len++] = (uint8_t)(address >> 8);
+	cmd[len++] = (uint8_t)(address);
+
+	// Mode bits must not switch the flash to continuous read mode
+	for (int i = 0; i < mode_len; i++)
+		cmd[len++] = 0xFF;
+
+	// Toggle SS pin to start transmission
+	qspi_ss_ctrl(true);
+
+	if (nor_flash.read_addr_mode == QSPI_MODE_NORMAL) {
+		ret = qspi_write(cmd, len);
+	} else {
+		ret = qspi_write(cmd, 1);
+		if (!ret)
+			ret = qspi_set_mode(nor_flash.read_addr_mode);
+		if (!ret)
+			ret = qspi_write(cmd + 1, len - 1);
+	}
+
+	if (!ret)
+		ret = qspi_set_mode(nor_flash.read_data_mode);
+
+	if (!ret && dummy_len)
+		ret = qspi_read(dummy, dummy_len);
+
+	if (ret)
+		spi_nor_read_end();
+
+	return ret;
+}
+
 int spi_nor_read(void *buffer, uint32_t address, uint32_t size)
 {
-	uint8_t cmd[5];
+	int ret;
 
 	if (!buffer)
 		return -ENULL;
 
-	if (nor_flash.addr_bytes == 4) {
-		cmd[0] = CMD_4READ;
-		cmd[1] = (uint8_t)(address >> 24);
-		cmd[2] = (uint8_t)(address >> 16);
-		cmd[3] = (uint8_t)(address >> 8);
-		cmd[4] = (uint8_t)(address);
-	} else {
-		cmd[0] = CMD_READ;
-		cmd[1] = (uint8_t)(address >> 16);
-		cmd[2] = (uint8_t)(address >> 8);
-		cmd[3] = (uint8_t)(address);
+	ret = spi_nor_xip_unmap();
+	if (ret)
+		return ret;
+
+	ret = spi_nor_read_begin(address);
+	if (ret)
+		return ret;
+
+	ret = qspi_read(buffer, size);
+
+	spi_nor_read_end();
+
+	return ret;
+}
+
+int spi_nor_read_start(void *buffer, uint32_t address, uint32_t size)
+{
+	int ret;
+
+	if (!buffer)
+		return -ENULL;
+
+	if (read_pending)
+		return -EINVALIDSTATE;
+
+	ret = spi_nor_xip_unmap();
+	if (ret)
+		return ret;
+
+	ret = spi_nor_read_begin(address);
+	if (ret)
+		return ret;
+
+	ret = qspi_read_start(buffer, size);
+	if (ret) {
+		spi_nor_read_end();
+		return ret;
 	}
 
-	return qspi_xfer(cmd, nor_flash.addr_bytes + 1, (uint8_t *)buffer, size);
+	read_pending = true;
+
+	return spi_nor_read_poll();
+}
+
+int spi_nor_read_poll(void)
+{
+	int ret;
+
+	if (!read_pending)
+		return 0;
+
+	ret = qspi_read_poll();
+	if (ret)
+		return ret;
+
+	spi_nor_read_end();
+	read_pending = false;
+
+	return 0;
 }
 
 int spi_nor_erase(uint32_t address, uint32_t sector_count)
 {
 	int ret;
 
+	ret = spi_nor_xip_unmap();
+	if (ret)
+		return ret;
+
 	if (sector_count == SPI_NOR_ERASE_CHIP) {
 		ret = spi_nor_erase_chip();
 		if (ret)
@@ -450,6 +988,25 @@ int spi_nor_erase(uint32_t address, uint32_t sector_count)
 	return 0;
 }
 
+const void *spi_nor_xip_map(uint32_t address, uint32_t size)
+{
+	uint32_t window = MIN(nor_flash.size_in_bytes, (uint32_t)SERVICE_QSPI0_XIP_SIZE);
+
+	if (read_pending || (nor_flash.flags & FLAG_4B_MODE))
+		return NULL;
+
+	if (address >= window || size > window - address)
+		return NULL;
+
+	if (!xip_enabled) {
+		if (qspi_xip_set(QSPI_XIP_ENABLE))
+			return NULL;
+		xip_enabled = true;
+	}
+
+	return (const void *)(BASE_ADDR_SERVICE_QSPI0_XIP + address);
+}
+
 uint32_t spi_nor_get_size(void)
 {
 	return nor_flash.size_in_bytes;
@@ -459,3 +1016,42 @@ uint32_t spi_nor_get_sector_size(void)
 {
 	return nor_flash.sector_size;
 }
+
+#ifdef SPI_NOR_BENCHMARK_ENABLE
+#define SPI_NOR_BENCHMARK_CHUNK (64 * KiB)
+#define SPI_NOR_BENCHMARK_SIZE  (1 * MiB)
+
+int spi_nor_benchmark(void)
+{
+	uint32_t size = MIN((uint32_t)SPI_NOR_BENCHMARK_SIZE, nor_flash.size_in_bytes);
+	uint64_t start, time_us, rate;
+	int ret = 0;
+	void *buf;
+
+	buf = malloc(SPI_NOR_BENCHMARK_CHUNK);
+	if (!buf)
+		return -ENOMEM;
+
+	// The first pass measures legacy receiving by one byte, the second one is burst mode
+	for (int burst = 0; burst < 2 && !ret; burst++) {
+		qspi_set_burst(burst);
+		start = timer_get_us();
+		for (uint32_t addr = 0; addr < size && !ret; addr += SPI_NOR_BENCHMARK_CHUNK) {
+			uint32_t len = MIN((uint32_t)SPI_NOR_BENCHMARK_CHUNK, size - addr);
+
+			ret = spi_nor_read(buf, addr, len);
+		}
+		time_us = MAX(timer_get_us() - start, (uint64_t)1);
+
+		// Bytes per microsecond are MB/s, rate is in KB/s
+		rate = (uint64_t)size * 1000 / time_us;
+		INFO("SPI NOR read %s: %lu bytes in %llu us, %llu.%03llu MB/s\n",
+		     burst ? "burst" : "by byte", size, time_us, rate / 1000, rate % 1000);
+	}
+
+	qspi_set_burst(true);
+	free(buf);
+
+	return ret;
+}
+#endif
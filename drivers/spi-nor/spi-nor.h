@@ -5,6 +5,13 @@
 
 #include <stdint.h>
 
+#define SPI_NOR_ERASE_TYPES 4
+
+typedef struct {
+	uint32_t size; // 0 if erase type is not supported
+	uint8_t opcode;
+} nor_erase_type_t;
+
 typedef struct {
 	char *name;
 	uint32_t page_size;
@@ -12,11 +19,75 @@ typedef struct {
 	uint32_t size_in_bytes;
 	uint8_t addr_bytes;
 	uint32_t flags;
+	uint8_t read_opcode;
+	uint8_t read_addr_mode; // QSPI_MODE_* for address and mode bits
+	uint8_t read_data_mode; // QSPI_MODE_* for dummy cycles and data
+	uint8_t read_mode_cycles;
+	uint8_t read_dummy_cycles;
+	uint8_t program_opcode;
+	uint8_t erase_opcode; // Erase command for sector_size
+	nor_erase_type_t erase_types[SPI_NOR_ERASE_TYPES]; // Supported erase granularities
 } nor_flash_t;
 
 int spi_nor_init(void);
+
+/**
+ * @brief Return the flash to the state expected by BootROM and the next boot stages: XIP window
+ *        is disabled and 4-byte address mode entered by spi_nor_init() is left. The flash
+ *        must be initialized again before the next operation.
+ *
+ * @return 0                - Success,
+ *         -EINVALIDSTATE   - Background reading isn't finished,
+ *         negative error code of QSPI driver
+ */
+int spi_nor_deinit(void);
 int spi_nor_write(const void *buffer, uint32_t address, uint32_t size);
 int spi_nor_read(void *buffer, uint32_t address, uint32_t size);
+
+/**
+ * @brief Start reading in background, the data is received by spi_nor_read_poll() calls.
+ *        No other flash operation is allowed until spi_nor_read_poll() returns 0.
+ *
+ * @param buffer  - Destination buffer
+ * @param address - Flash address
+ * @param size    - Number of bytes to read
+ *
+ * @return Number of bytes which are not received yet or negative error code
+ */
+int spi_nor_read_start(void *buffer, uint32_t address, uint32_t size);
+
+/**
+ * @brief Continue reading started by spi_nor_read_start()
+ *
+ * @return Number of bytes which are not received yet, 0 when reading is finished
+ */
+int spi_nor_read_poll(void);
 int spi_nor_erase(uint32_t address, uint32_t sector_count);
+
+/**
+ * @brief Map flash region to QSPI0 XIP window. The window is disabled by the next read, write
+ *        or erase operation, so the pointer must not be used after it.
+ *
+ * @param address - Flash address
+ * @param size    - Size of the region
+ *
+ * @return Pointer to the region or NULL if the region can't be accessed through XIP window
+ */
+const void *spi_nor_xip_map(uint32_t address, uint32_t size);
+
+/**
+ * @brief Disable QSPI0 XIP window enabled by spi_nor_xip_map()
+ *
+ * @return 0 on success or negative error code
+ */
+int spi_nor_xip_unmap(void);
 uint32_t spi_nor_get_size(void);
 uint32_t spi_nor_get_sector_size(void);
+
+/**
+ * @brief Measure read throughput of the flash with and without QSPI burst mode, the results
+ *        are printed to log. It's available with SPI_NOR_BENCHMARK_ENABLE.
+ *
+ * @return 0 on success or negative error code
+ */
+int spi_nor_benchmark(void);
@@ -138,3 +138,18 @@ uint64_t timer_get_us(void)
 
 	return __timer_get_ticks() / (freq / USEC_IN_SEC);
 }
+
+uint64_t timer_get_ticks(void)
+{
+	return __timer_get_ticks();
+}
+
+uint64_t timer_ticks_to_us(uint64_t ticks)
+{
+	uint32_t freq;
+
+	if (!timer.registered || timer.ops.get_clock(&freq))
+		return 0;
+
+	return ticks / (freq / USEC_IN_SEC);
+}
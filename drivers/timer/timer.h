@@ -95,6 +95,22 @@ void timer_delay_us(uint32_t num_usec);
  */
 uint64_t timer_get_us(void);
 
+/**
+ * @brief Get timer ticks from boot start
+ *
+ * Cheaper than timer_get_us(), intended for accumulating short intervals
+ */
+uint64_t timer_get_ticks(void);
+
+/**
+ * @brief Convert timer ticks to microseconds
+ *
+ * @param ticks - Number of ticks
+ *
+ * @return Microseconds, 0 if the timer isn't registered
+ */
+uint64_t timer_ticks_to_us(uint64_t ticks);
+
 /**
  * @brief Register timer hardware
  *
@@ -14,17 +14,21 @@
 
 struct bootstage_record {
 	uint64_t time_us;
-	uint64_t reserved; /* Reserved for duration time */
+	uint64_t duration_us; /* Accumulated duration time */
 	enum bootstage_id id;
 };
 
 struct bootstage_data {
 	uint32_t rec_count;
 	struct bootstage_record record[PLAT_BOOTSTAGE_RECORD_COUNT];
+	uint32_t obj_count;
+	struct bootstage_obj_record obj[PLAT_BOOTSTAGE_OBJ_COUNT];
+	struct bootstage_obj_record *obj_cur; /* Record of the object being processed */
+	bool frozen; /* Durations and object records are not changed */
 };
 
 enum {
-	BOOTSTAGE_VERSION = 0x0100,
+	BOOTSTAGE_VERSION = 0x0201,
 	BOOTSTAGE_MAGIC = 0x45FBE3D6,
 };
 
@@ -33,6 +37,7 @@ struct bootstage_hdr {
 	uint32_t count; /* Number of records */
 	uint32_t size; /* Total data size (non-zero if valid) */
 	uint32_t magic; /* Magic number */
+	uint32_t obj_count; /* Number of SBIMG object records */
 };
 
 static struct bootstage_data bootstage = { 0 };
@@ -110,6 +115,69 @@ uint64_t bootstage_mark(enum bootstage_id id)
 	return bootstage_add_record(id, timer_get_us());
 }
 
+void bootstage_add_duration(enum bootstage_id id, uint64_t duration_us)
+{
+	struct bootstage_data *data = &bootstage;
+	struct bootstage_record *rec;
+
+	if (data->frozen)
+		return;
+
+	rec = find_id(data, id);
+	if (!rec) {
+		bootstage_add_record(id, timer_get_us());
+		rec = find_id(data, id);
+		if (!rec)
+			return;
+	}
+
+	rec->duration_us += duration_us;
+}
+
+void bootstage_obj_start(uint32_t offset, uint32_t flags, uint32_t size)
+{
+	struct bootstage_data *data = &bootstage;
+	struct bootstage_obj_record *rec;
+
+	if (data->frozen)
+		return;
+
+	if (data->obj_count >= PLAT_BOOTSTAGE_OBJ_COUNT) {
+		if (data->obj_cur)
+			WARN("Bootstage object space exhausted\n");
+		data->obj_cur = NULL;
+		return;
+	}
+
+	rec = &data->obj[data->obj_count++];
+	memset(rec, 0, sizeof(*rec));
+	rec->offset = offset;
+	rec->flags = flags;
+	rec->size = size;
+	data->obj_cur = rec;
+}
+
+void bootstage_obj_add_duration(enum bootstage_obj_step step, uint64_t duration_us)
+{
+	struct bootstage_obj_record *rec = bootstage.obj_cur;
+
+	if (!bootstage.frozen && rec && step < BOOTSTAGE_OBJ_STEP_COUNT)
+		rec->duration_us[step] += duration_us;
+}
+
+void bootstage_freeze(void)
+{
+	bootstage.obj_cur = NULL;
+	bootstage.frozen = true;
+}
+
+const struct bootstage_obj_record *bootstage_obj_get(uint32_t *count)
+{
+	*count = bootstage.obj_count;
+
+	return bootstage.obj;
+}
+
 int64_t bootstage_get_timestamp(enum bootstage_id id)
 {
 	struct bootstage_data *data = &bootstage;
@@ -144,12 +212,15 @@ int bootstage_export(void *base, int size)
 	hdr->count = data->rec_count;
 	hdr->size = 0;
 	hdr->magic = BOOTSTAGE_MAGIC;
+	hdr->obj_count = data->obj_count;
 	ptr += sizeof(*hdr);
 
 	/* Write the records, silently stopping when we run out of space */
 	for (rec = data->record, i = 0; i < data->rec_count; i++, rec++)
 		append_data(&ptr, end, rec, sizeof(*rec));
 
+	append_data(&ptr, end, data->obj, data->obj_count * sizeof(*data->obj));
+
 	/* Check for buffer overflow */
 	if (ptr > end) {
 		VERBOSE("%s: Not enough space for bootstage export\n", __func__);
@@ -189,10 +260,10 @@ int bootstage_import(const void *base, int size)
 		return -ENOSPC;
 	}
 
-	if (hdr->count * sizeof(*rec) > hdr->size) {
-		VERBOSE("%s: Bootstage has %lu records needing %llu bytes, but "
+	if (hdr->count * sizeof(*rec) + hdr->obj_count * sizeof(*data->obj) > hdr->size) {
+		VERBOSE("%s: Bootstage has %lu records and %lu object records, but "
 		        "only %lu bytes is available\n",
-		        __func__, hdr->count, (uint64_t)hdr->count * sizeof(*rec), hdr->size);
+		        __func__, hdr->count, hdr->obj_count, hdr->size);
 		return -ENOSPC;
 	}
 
@@ -208,14 +279,24 @@ int bootstage_import(const void *base, int size)
 		return -ENOSPC;
 	}
 
+	if (data->obj_count + hdr->obj_count > PLAT_BOOTSTAGE_OBJ_COUNT) {
+		VERBOSE("%s: Bootstage has %lu object records, we have space for %lu\n",
+		        __func__, hdr->obj_count, PLAT_BOOTSTAGE_OBJ_COUNT - data->obj_count);
+		return -ENOSPC;
+	}
+
 	ptr += sizeof(*hdr);
 
 	/* Read the records */
 	rec_size = hdr->count * sizeof(*data->record);
 	memcpy(data->record + data->rec_count, ptr, rec_size);
 
+	ptr += rec_size;
+	memcpy(data->obj + data->obj_count, ptr, hdr->obj_count * sizeof(*data->obj));
+
 	/* Mark the records as read */
 	data->rec_count += hdr->count;
+	data->obj_count += hdr->obj_count;
 	VERBOSE("Imported %lu records\n", hdr->count);
 
 	return 0;
@@ -20,6 +20,13 @@ enum bootstage_id {
 	BOOTSTAGE_ID_SBL_S2_LOAD_COMPLETE,
 	BOOTSTAGE_ID_SBL_S3_START,
 	BOOTSTAGE_ID_TF_A_START,
+	/*
+	 * Accumulated durations of SBL-S2 image loading: time when CPU waits for the flash
+	 * and time spent for payload hashing and deciphering. If reading is overlapped with
+	 * processing, their sum is close to LOAD_COMPLETE - LOAD_START.
+	 */
+	BOOTSTAGE_ID_SBL_S2_LOAD_FLASH_WAIT,
+	BOOTSTAGE_ID_SBL_S2_LOAD_PROCESS,
 
 	// The IDs below has the same value as in the U-Boot in order to reused it
 	BOOTSTAGE_ID_RUN_OS = 15,
@@ -27,6 +34,26 @@ enum bootstage_id {
 	BOOTSTAGE_ID_START_TFTF = BOOTSTAGE_ID_START_UBOOT_F,
 };
 
+/*
+ * Steps of SBIMG object processing which durations are recorded per object
+ */
+enum bootstage_obj_step {
+	BOOTSTAGE_OBJ_FLASH_READ = 0,
+	BOOTSTAGE_OBJ_HEADER_HASH,
+	BOOTSTAGE_OBJ_RSA_VERIFY,
+	BOOTSTAGE_OBJ_AES_DECRYPT,
+	BOOTSTAGE_OBJ_PAYLOAD_HASH,
+	BOOTSTAGE_OBJ_DECOMPRESS,
+	BOOTSTAGE_OBJ_STEP_COUNT,
+};
+
+struct bootstage_obj_record {
+	uint32_t offset; /* Object offset in the flash */
+	uint32_t flags; /* SBIMG header flags, object type is in bits 0-2 */
+	uint32_t size; /* Payload size */
+	uint32_t duration_us[BOOTSTAGE_OBJ_STEP_COUNT];
+};
+
 /**
  * Record bootstage with passed id
  * @id: Bootstage id to record this timestamp against
@@ -35,6 +62,42 @@ enum bootstage_id {
  */
 uint64_t bootstage_mark(enum bootstage_id id);
 
+/**
+ * Add duration to the record with passed id, the record is created if needed
+ * @id: Bootstage id to accumulate duration against
+ * @duration_us: Duration in microseconds
+ */
+void bootstage_add_duration(enum bootstage_id id, uint64_t duration_us);
+
+/**
+ * Start a new SBIMG object record, following durations are accumulated against it
+ * @offset: Object offset in the flash
+ * @flags: SBIMG header flags
+ * @size: Payload size
+ */
+void bootstage_obj_start(uint32_t offset, uint32_t flags, uint32_t size);
+
+/**
+ * Add duration of the step to the current SBIMG object record
+ * @step: Processing step
+ * @duration_us: Duration in microseconds
+ */
+void bootstage_obj_add_duration(enum bootstage_obj_step step, uint64_t duration_us);
+
+/**
+ * Stop accumulation of durations and SBIMG object records, so the imported ones keep
+ * timings of the boot. Timestamps are still recorded.
+ */
+void bootstage_freeze(void);
+
+/**
+ * Get SBIMG object records
+ *
+ * @param count	Number of records
+ * Return: pointer to the first record
+ */
+const struct bootstage_obj_record *bootstage_obj_get(uint32_t *count);
+
 /**
  * Get timestamp for Bootstage ID
  *
@@ -46,6 +109,8 @@ int64_t bootstage_get_timestamp(enum bootstage_id id);
 /**
  * Export bootstage data into memory
  *
+ * SBIMG object records follow the bootstage records.
+ *
  * @param base	Base address of memory buffer
  * @param size	Size of memory buffer
  * Return: 0 if exported ok, -EPERM if out of space
@@ -0,0 +1,280 @@
+// SPDX-License-Identifier: MIT
+// Copyright 2025 RnD Center "ELVEES", JSC
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <libs/errors.h>
+#include <libs/utils-def.h>
+
+#include "lz4.h"
+
+// Frame descriptor: magic, FLG and BD bytes, content size and header checksum
+#define LZ4_DESC_SIZE   6
+#define LZ4_HEADER_SIZE 15
+
+#define LZ4_FLG_VERSION_MASK   0xC0
+#define LZ4_FLG_VERSION        0x40
+#define LZ4_FLG_BLOCK_CHKSUM   BIT(4)
+#define LZ4_FLG_CONTENT_SIZE   BIT(3)
+#define LZ4_FLG_CONTENT_CHKSUM BIT(2)
+#define LZ4_FLG_RESERVED       BIT(1)
+#define LZ4_FLG_DICT_ID        BIT(0)
+#define LZ4_BD_RESERVED_MASK   0x8F
+
+#define LZ4_BLOCK_RAW       BIT(31)
+#define LZ4_CHKSUM_SIZE     4
+#define LZ4_MIN_MATCH       4
+#define LZ4_LENGTH_EXTENDED 15
+
+enum lz4_state {
+	LZ4_STATE_HEADER,
+	LZ4_STATE_BLOCK_SIZE,
+	LZ4_STATE_BLOCK_RAW,
+	LZ4_STATE_TOKEN,
+	LZ4_STATE_LITERAL_LEN,
+	LZ4_STATE_LITERALS,
+	LZ4_STATE_OFFSET,
+	LZ4_STATE_MATCH_LEN,
+	LZ4_STATE_SKIP,
+	LZ4_STATE_DONE,
+};
+
+static uint32_t get_le32(const uint8_t *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+	       ((uint32_t)p[3] << 24);
+}
+
+static int header_parse(lz4_stream_t *s)
+{
+	uint8_t flg = s->header[4];
+	uint8_t bd = s->header[5];
+
+	if (get_le32(s->header) != LZ4_FRAME_MAGIC ||
+	    (flg & LZ4_FLG_VERSION_MASK) != LZ4_FLG_VERSION ||
+	    (flg & (LZ4_FLG_RESERVED | LZ4_FLG_DICT_ID)) || !(flg & LZ4_FLG_CONTENT_SIZE) ||
+	    (bd & LZ4_BD_RESERVED_MASK))
+		return -EINVALIDDATA;
+
+	if (s->header_len < LZ4_HEADER_SIZE)
+		return 0;
+
+	// Content size is 64-bit, but it can't exceed the address space
+	if (get_le32(&s->header[10]))
+		return -EINVALIDDATA;
+
+	s->dst_size = get_le32(&s->header[6]);
+	s->state = LZ4_STATE_BLOCK_SIZE;
+
+	return 0;
+}
+
+// Skip checksum if the frame has it and go to the next state
+static void skip_checksum(lz4_stream_t *s, uint8_t flag, int next_state)
+{
+	if (s->header[4] & flag) {
+		s->skip = LZ4_CHKSUM_SIZE;
+		s->next_state = next_state;
+		s->state = LZ4_STATE_SKIP;
+	} else {
+		s->state = next_state;
+	}
+}
+
+// Match may overlap the output, then it repeats the last offset bytes
+static void match_copy(uint8_t *dst, size_t offset, size_t len)
+{
+	const uint8_t *src = dst - offset;
+
+	if (offset >= len)
+		memcpy(dst, src, len);
+	else if (offset == 1)
+		memset(dst, *src, len);
+	else
+		while (len--)
+			*dst++ = *src++;
+}
+
+// Copy the match with offset collected in value and go to the next sequence
+static int match_apply(lz4_stream_t *s)
+{
+	if (s->match_len > s->dst_size - s->dst_pos)
+		return -EINVALIDDATA;
+
+	match_copy(s->dst + s->dst_pos, s->value, s->match_len);
+	s->dst_pos += s->match_len;
+	s->value = 0;
+	s->value_len = 0;
+	s->state = LZ4_STATE_TOKEN;
+
+	return 0;
+}
+
+void lz4_stream_init(lz4_stream_t *s, uint8_t *dst)
+{
+	memset(s, 0, sizeof(*s));
+	s->dst = dst;
+	s->state = LZ4_STATE_HEADER;
+}
+
+int lz4_stream_decode(lz4_stream_t *s, const uint8_t *src, size_t len)
+{
+	const uint8_t *p = src;
+	const uint8_t *end = src + len;
+
+	while (p < end) {
+		size_t left = end - p;
+		// Input of the current block, sequences never cross the block border
+		size_t avail = MIN(left, s->block_left);
+		size_t n;
+
+		switch (s->state) {
+		case LZ4_STATE_HEADER: {
+			size_t need = (s->header_len < LZ4_DESC_SIZE) ? LZ4_DESC_SIZE :
+			                                                LZ4_HEADER_SIZE;
+
+			n = MIN(left, need - s->header_len);
+			memcpy(&s->header[s->header_len], p, n);
+			s->header_len += n;
+			p += n;
+
+			if (s->header_len == need && header_parse(s))
+				return -EINVALIDDATA;
+
+			// Caller checks the content size before the output is written
+			if (s->state != LZ4_STATE_HEADER)
+				return p - src;
+			break;
+		}
+
+		case LZ4_STATE_BLOCK_SIZE:
+			s->value |= (uint32_t)*p++ << (8 * s->value_len++);
+			if (s->value_len < 4)
+				break;
+
+			if (!s->value) {
+				skip_checksum(s, LZ4_FLG_CONTENT_CHKSUM, LZ4_STATE_DONE);
+			} else {
+				s->block_left = s->value & ~LZ4_BLOCK_RAW;
+				s->state = (s->value & LZ4_BLOCK_RAW) ? LZ4_STATE_BLOCK_RAW :
+				                                        LZ4_STATE_TOKEN;
+			}
+			s->value = 0;
+			s->value_len = 0;
+			break;
+
+		case LZ4_STATE_BLOCK_RAW:
+			if (avail > s->dst_size - s->dst_pos)
+				return -EINVALIDDATA;
+
+			memcpy(s->dst + s->dst_pos, p, avail);
+			s->dst_pos += avail;
+			s->block_left -= avail;
+			p += avail;
+
+			if (!s->block_left)
+				skip_checksum(s, LZ4_FLG_BLOCK_CHKSUM, LZ4_STATE_BLOCK_SIZE);
+			break;
+
+		case LZ4_STATE_TOKEN:
+			if (!avail)
+				return -EINVALIDDATA;
+
+			s->literal_len = *p >> 4;
+			s->match_len = (*p & 0xF) + LZ4_MIN_MATCH;
+			s->state = (s->literal_len == LZ4_LENGTH_EXTENDED) ? LZ4_STATE_LITERAL_LEN :
+			                                                     LZ4_STATE_LITERALS;
+			s->block_left--;
+			p++;
+			break;
+
+		case LZ4_STATE_LITERAL_LEN:
+			if (!avail)
+				return -EINVALIDDATA;
+
+			s->literal_len += *p;
+			if (*p != 0xFF)
+				s->state = LZ4_STATE_LITERALS;
+			s->block_left--;
+			p++;
+			break;
+
+		case LZ4_STATE_LITERALS:
+			n = MIN(avail, s->literal_len);
+			if (n > s->dst_size - s->dst_pos)
+				return -EINVALIDDATA;
+
+			memcpy(s->dst + s->dst_pos, p, n);
+			s->dst_pos += n;
+			s->literal_len -= n;
+			s->block_left -= n;
+			p += n;
+
+			if (s->literal_len) {
+				if (!s->block_left)
+					return -EINVALIDDATA;
+			} else if (!s->block_left) {
+				// The last sequence of the block has literals only
+				skip_checksum(s, LZ4_FLG_BLOCK_CHKSUM, LZ4_STATE_BLOCK_SIZE);
+			} else {
+				s->state = LZ4_STATE_OFFSET;
+			}
+			break;
+
+		case LZ4_STATE_OFFSET:
+			if (!avail)
+				return -EINVALIDDATA;
+
+			s->value |= (uint32_t)*p++ << (8 * s->value_len++);
+			s->block_left--;
+			if (s->value_len < 2)
+				break;
+
+			if (!s->value || s->value > s->dst_pos)
+				return -EINVALIDDATA;
+
+			if (s->match_len == LZ4_LENGTH_EXTENDED + LZ4_MIN_MATCH)
+				s->state = LZ4_STATE_MATCH_LEN;
+			else if (match_apply(s))
+				return -EINVALIDDATA;
+			break;
+
+		case LZ4_STATE_MATCH_LEN:
+			if (!avail)
+				return -EINVALIDDATA;
+
+			s->match_len += *p;
+			s->block_left--;
+			if (*p++ != 0xFF && match_apply(s))
+				return -EINVALIDDATA;
+			break;
+
+		case LZ4_STATE_SKIP:
+			n = MIN(left, s->skip);
+			s->skip -= n;
+			p += n;
+			if (!s->skip)
+				s->state = s->next_state;
+			break;
+
+		default:
+			// Nothing is expected after the end of the frame
+			return -EINVALIDDATA;
+		}
+	}
+
+	return p - src;
+}
+
+bool lz4_stream_has_header(const lz4_stream_t *s)
+{
+	return s->state != LZ4_STATE_HEADER;
+}
+
+bool lz4_stream_done(const lz4_stream_t *s)
+{
+	return s->state == LZ4_STATE_DONE && s->dst_pos == s->dst_size;
+}
@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: MIT
+// Copyright 2025 RnD Center "ELVEES", JSC
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define LZ4_FRAME_MAGIC      0x184D2204
+#define LZ4_FRAME_HEADER_MAX 19
+
+/**
+ * State of LZ4 frame decompression. Input is passed by pieces of any size, output is written
+ * to the flat buffer, so matches refer to the data decompressed before and no window is kept.
+ * Frame must have the content size field, dictionaries are not supported. Header, block and
+ * content checksums are skipped, integrity of the compressed data is checked by the caller.
+ */
+typedef struct {
+	uint8_t *dst;
+	// Content size from the frame header, output never goes beyond it
+	size_t dst_size;
+	size_t dst_pos;
+	int state;
+	int next_state;
+	uint8_t header[LZ4_FRAME_HEADER_MAX];
+	size_t header_len;
+	uint32_t value;
+	int value_len;
+	size_t skip;
+	size_t block_left;
+	size_t literal_len;
+	size_t match_len;
+} lz4_stream_t;
+
+/**
+ * @brief Initialize LZ4 frame decompression
+ *
+ * @param s   - Decompression state
+ * @param dst - Output buffer, it can be set after the frame header is decoded
+ */
+void lz4_stream_init(lz4_stream_t *s, uint8_t *dst);
+
+/**
+ * @brief Decompress the next piece of LZ4 frame. Decoding stops right after the frame header,
+ *        so the caller can check dst_size before anything is written to dst.
+ *
+ * @param s   - Decompression state
+ * @param src - Compressed data
+ * @param len - Size of compressed data
+ *
+ * @return Number of consumed bytes,
+ *         -EINVALIDDATA - Malformed or unsupported frame, output overflow
+ */
+int lz4_stream_decode(lz4_stream_t *s, const uint8_t *src, size_t len);
+
+/**
+ * @brief Check that the frame header is decoded and dst_size is known
+ */
+bool lz4_stream_has_header(const lz4_stream_t *s);
+
+/**
+ * @brief Check that the whole frame is decoded and the content size is reached
+ */
+bool lz4_stream_done(const lz4_stream_t *s);
+
+#ifdef __cplusplus
+}
+#endif
@@ -27,7 +27,18 @@
 #define MCOM03_XTI_CLK_HZ 27000000
 #define UART_CLK_HZ       MCOM03_XTI_CLK_HZ
 
-#define PLAT_BOOTSTAGE_RECORD_COUNT 9
+// Flash layout, SBL environment and firmware slots are used by SBL-S2 and SBL-S3
+#define PLAT_ENV_SIZE          0x10000
+#define PLAT_SBL_ENV_OFF       -0x30000
+#define PLAT_UBOOT_ENV_OFF     0xFE0000
+#define PLAT_UBOOT_OLD_ENV_OFF -0x40000
+
+#define PLAT_OFFSET_FIRMWARE_A 0x200000
+#define PLAT_OFFSET_FIRMWARE_B 0x600000
+#define PLAT_OFFSET_FIRMWARE_R 0xA10000
+
+#define PLAT_BOOTSTAGE_RECORD_COUNT 11
+#define PLAT_BOOTSTAGE_OBJ_COUNT    16
 #define PLAT_BOOTSTAGE_BASE         0x47C00000
 #define PLAT_BOOTSTAGE_SIZE         0x800
 
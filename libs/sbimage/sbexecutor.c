@@ -9,6 +9,8 @@
 #include <drivers/otp/otp.h>
 #include <libs/errors.h>
 #include <libs/log.h>
+#include <libs/lz4/lz4.h>
+#include <libs/utils-def.h>
 #include <third-party/aes/aes.h>
 #include <third-party/crypto/bigint.h>
 #include <third-party/crypto/bigint_impl.h>
@@ -16,6 +18,11 @@
 #include <third-party/crypto/crypto.h>
 #include <third-party/crypto/crypto_misc.h>
 
+#if defined(BOOTSTAGE_ENABLE)
+#include <drivers/timer/timer.h>
+#include <libs/bootstage/bootstage.h>
+#endif
+
 #include "sbexecutor.h"
 #include "sbimage.h"
 #include "sbstatus-print.h"
@@ -46,10 +53,10 @@
 		}                                                          \
 	} while (0)
 
-#define EXECUTE(addr)                                       \
-	do {                                                \
-		next_img_t next_image = (next_img_t)(addr); \
-		next_image();                               \
+#define EXECUTE(addr)                                                  \
+	do {                                                           \
+		next_img_t next_image = (next_img_t)(uintptr_t)(addr); \
+		next_image();                                          \
 	} while (0)
 
 #define SET_CERT_NUMBER(sign_cert_id, num)                                \
@@ -61,8 +68,27 @@
 	} while (0);
 ;
 
+// Public exponent F4 = 65537 = 2^16 + 1
+#define RSA_EXP_F4         0x10001
+#define RSA_EXP_F4_SQUARES 16
+
+#if defined(BOOTSTAGE_ENABLE)
+// Durations of the object processing steps are accumulated in its bootstage record
+#define STEP_START(var)     uint64_t var = timer_get_us()
+#define STEP_END(step, var) bootstage_obj_add_duration((step), timer_get_us() - (var))
+#else
+#define STEP_START(var)
+#define STEP_END(step, var)
+#endif
+
 typedef const volatile int (*next_img_t)(void);
 
+COMPILE_TIME_ASSERT((SBIMG_CHUNK_SIZE % AES_BLOCK_LEN) == 0);
+COMPILE_TIME_ASSERT((SBIMG_POLL_SLICE % AES_BLOCK_LEN) == 0);
+COMPILE_TIME_ASSERT((SBIMG_FUSED_BLOCK % AES_BLOCK_LEN) == 0);
+COMPILE_TIME_ASSERT(RSA_MOD_LEN <= CONFIG_BIGINT_ARENA_MOD_BYTES);
+COMPILE_TIME_ASSERT(SBIMG_READAHEAD_SIZE >= HEADER_SIZE + RSA_MOD_LEN);
+
 static const volatile void *(*memset_s)(void *, int,
                                         size_t) = (const volatile void *(*)(void *, int,
                                                                             size_t))memset;
@@ -74,37 +100,116 @@ static const uint8_t iv[AES_BLOCK_LEN] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0
 	                                   0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10 };
 static uint8_t encrypted_key[AES_KEY_LEN];
 static uint32_t key_number = 0;
+
+// Expanded CEK, reused while the encryption key object and its number stay the same
+static struct AES_ctx cek_ctx;
+static uint8_t cek_encrypted_key[AES_KEY_LEN];
+static uint32_t cek_key_number = 0;
+static bool cek_valid = false;
 static X509_CTX *x509_root = NULL;
 
+// DER of the parsed certificates, their X.509 contexts point into it until crypto_free()
+static uint8_t cert_store[SBIMG_CERT_STORE_SIZE];
+static size_t cert_store_used = 0;
+
 static uint32_t sign_cert_arr[CONFIG_X509_MAX_CA_CERTS] = { 0 };
 static X509_CTX *non_root_cert[CONFIG_X509_MAX_CA_CERTS] = { NULL };
 static volatile uint8_t cert_index = 0;
 static volatile uint8_t end_cert_has_been_handled = 0;
 
+// Payload digests from the last manifest and index of the next payload to be checked
+static uint8_t manifest_dgst[SBIMG_MANIFEST_MAX_ENTRIES][SHA_DIGEST_LEN];
+static uint32_t manifest_count = 0;
+static uint32_t manifest_index = 0;
+
+// Certificates and payloads verified by the check pass, reused after sblimg_rewind()
+typedef struct {
+	uintptr_t offset;
+	uint8_t header_dgst[SHA_DIGEST_LEN];
+	uint8_t payload_dgst[SHA_DIGEST_LEN];
+} verified_obj_t;
+
+static verified_obj_t verified[SBIMG_VERIFIED_MAX_OBJECTS];
+static int verified_count = 0;
+static int verified_index = 0;
+static bool verified_reuse = false;
+
 static sb_mem_t sb_mem = { 0 };
 
+// Header and loaded size of the payload without return, it's started by sblimg_finish()
+static sbimghdr_t exec_header;
+static size_t exec_size = 0;
+
+// Image data read ahead, pending is set while it's filled by read_start_func in background
+static struct {
+	uintptr_t offset;
+	size_t len;
+	bool pending;
+	uint8_t buf[SBIMG_READAHEAD_SIZE];
+} readahead;
+
+#if defined(BOOTSTAGE_ENABLE)
+// Timer ticks spent for deciphering of the current chunk, hashing is interleaved with it
+static uint64_t aes_ticks = 0;
+#endif
+
+static bool rsa_exp_is_f4(const RSA_CTX *rsa_ctx)
+{
+	return rsa_ctx->e->size == 1 && rsa_ctx->e->comps[0] == RSA_EXP_F4;
+}
+
+/**
+ * Raise bi to the power of 65537 modulo the key modulus by 16 squarings and one multiplication.
+ * Barrett constants of the modulus are prepared once by RSA_pub_key_new(), temporaries are
+ * taken from the free list of the context, so nothing is cloned per signature. bi is consumed.
+ */
+static bigint *rsa_pow_f4(BI_CTX *ctx, bigint *bi)
+{
+	bigint *r = bi_copy(bi);
+
+	ctx->mod_offset = BIGINT_M_OFFSET;
+
+	for (int i = 0; i < RSA_EXP_F4_SQUARES; i++) {
+		r = bi_square(ctx, r);
+		if (r == NULL)
+			return NULL;
+
+		r = bi_residue(ctx, r);
+		if (r == NULL)
+			return NULL;
+	}
+
+	r = bi_multiply(ctx, r, bi);
+	if (r == NULL)
+		return NULL;
+
+	return bi_residue(ctx, r);
+}
+
 /**
  * Take a signature, decrypt and verify it.
  *
- * 1 - error, 0 - OK, -1 - malloc error
+ * Exponentiation is done in the bigint context of the key, which keeps reduction constants
+ * of the modulus since the certificate is parsed. Temporaries are taken from the bigint arena
+ * and go back to it when the caller clears the cache of the key.
+ *
+ * 1 - error, 0 - OK, -1 - out of bigint arena
  */
-static int sig_verify(BI_CTX *ctx, const uint8_t *sig, int sig_len, bigint *modulus,
-                      bigint *pub_exp, bigint **bir)
+static int sig_verify(RSA_CTX *rsa_ctx, const uint8_t *sig, int sig_len, bigint **bir)
 {
 	int i;
 	bigint *decrypted_bi, *dat_bi;
+	BI_CTX *ctx = rsa_ctx->bi_ctx;
 	int res = 1;
-	uint8_t *block = (uint8_t *)malloc(sig_len);
-	if (block == NULL) {
-		res = -1;
-		return res;
-	}
+	uint8_t block[CONFIG_BIGINT_ARENA_MOD_BYTES];
 
 	uint8_t sig_prefix_size = sizeof(sig_prefix_sha256);
 	uint8_t hash_len = sig_prefix_sha256[sig_prefix_size - 1];
 
+	STEP_START(start);
+
 	/* check length (#A) */
-	if (sig_len < 2 + 8 + 1 + sig_prefix_size + hash_len)
+	if (sig_len < 2 + 8 + 1 + sig_prefix_size + hash_len || sig_len > (int)sizeof(block))
 		goto err;
 
 	/* decrypt */
@@ -115,8 +220,18 @@ static int sig_verify(BI_CTX *ctx, const uint8_t *sig, int sig_len, bigint *modu
 	}
 	ctx->mod_offset = BIGINT_M_OFFSET;
 
-	/* convert to a normal block */
-	decrypted_bi = bi_mod_power2(ctx, dat_bi, modulus, pub_exp);
+	/* signature representative must be less than the modulus */
+	if (bi_compare(dat_bi, rsa_ctx->m) >= 0) {
+		bi_free(ctx, dat_bi);
+		goto err;
+	}
+
+	/* convert to a normal block, the exponent is permanent and isn't freed */
+	if (rsa_exp_is_f4(rsa_ctx))
+		decrypted_bi = rsa_pow_f4(ctx, dat_bi);
+	else
+		decrypted_bi = bi_mod_power(ctx, dat_bi, rsa_ctx->e);
+
 	if (decrypted_bi == NULL) {
 		res = -1;
 		goto err;
@@ -152,9 +267,7 @@ static int sig_verify(BI_CTX *ctx, const uint8_t *sig, int sig_len, bigint *modu
 	}
 	res = 0;
 err:
-	free(block);
-	/* save a few bytes of memory */
-	bi_clear_cache(ctx);
+	STEP_END(BOOTSTAGE_OBJ_RSA_VERIFY, start);
 	return res;
 }
 
@@ -165,8 +278,7 @@ static int sbimg_x509_cert_verify(const X509_CTX *ca_cert, const X509_CTX *cert,
 	int ret = X509_OK;
 	bigint *cert_sig;
 	X509_CTX *next_cert = NULL;
-	BI_CTX *ctx = NULL;
-	bigint *mod = NULL, *expn = NULL;
+	RSA_CTX *rsa_ctx = NULL;
 	int match_ca_cert = 0;
 	uint8_t is_self_signed = 0;
 
@@ -179,9 +291,7 @@ static int sbimg_x509_cert_verify(const X509_CTX *ca_cert, const X509_CTX *cert,
 	   to check the signature */
 	if (asn1_compare_dn(cert->ca_cert_dn, cert->cert_dn) == 0) {
 		is_self_signed = 1;
-		ctx = cert->rsa_ctx->bi_ctx;
-		mod = cert->rsa_ctx->m;
-		expn = cert->rsa_ctx->e;
+		rsa_ctx = cert->rsa_ctx;
 	}
 
 	if (cert->basic_constraint_present) {
@@ -224,9 +334,7 @@ static int sbimg_x509_cert_verify(const X509_CTX *ca_cert, const X509_CTX *cert,
 			if (asn1_compare_dn(cert->ca_cert_dn, ca_cert->cert_dn) == 0) {
 				/* use this CA certificate for signature verification */
 				match_ca_cert = true;
-				ctx = ca_cert->rsa_ctx->bi_ctx;
-				mod = ca_cert->rsa_ctx->m;
-				expn = ca_cert->rsa_ctx->e;
+				rsa_ctx = ca_cert->rsa_ctx;
 			}
 		}
 
@@ -242,9 +350,7 @@ static int sbimg_x509_cert_verify(const X509_CTX *ca_cert, const X509_CTX *cert,
 		goto end_verify;
 	} else /* use the next certificate in the chain for signature verify */
 	{
-		ctx = next_cert->rsa_ctx->bi_ctx;
-		mod = next_cert->rsa_ctx->m;
-		expn = next_cert->rsa_ctx->e;
+		rsa_ctx = next_cert->rsa_ctx;
 	}
 
 	/* cert is self signed */
@@ -254,27 +360,21 @@ static int sbimg_x509_cert_verify(const X509_CTX *ca_cert, const X509_CTX *cert,
 	}
 
 	/* check the signature */
-	bigint *mod_clone = bi_clone(ctx, mod);
-	if (mod_clone == NULL)
-		return X509_MALLOC_ERROR;
-	bigint *expn_clone = bi_clone(ctx, expn);
-	if (expn_clone == NULL)
-		return X509_MALLOC_ERROR;
-
-	int sig_ver_res =
-		sig_verify(ctx, cert->signature, cert->sig_len, mod_clone, expn_clone, &cert_sig);
+	int sig_ver_res = sig_verify(rsa_ctx, cert->signature, cert->sig_len, &cert_sig);
 
 	if ((sig_ver_res == 0) && cert_sig && cert->digest) {
 		if (bi_compare(cert_sig, cert->digest) != 0)
 			ret = X509_VFY_ERROR_BAD_SIGNATURE;
 
-		bi_free(ctx, cert_sig);
+		bi_free(rsa_ctx->bi_ctx, cert_sig);
 	} else if (sig_ver_res == -1) {
 		ret = X509_MALLOC_ERROR;
 	} else {
 		ret = X509_VFY_ERROR_BAD_SIGNATURE;
 	}
 
+	bi_clear_cache(rsa_ctx->bi_ctx);
+
 end_verify:
 	return ret;
 }
@@ -290,17 +390,8 @@ static int signature_verify_hash(const uint8_t *sha256_dgst, const uint8_t *sign
 		return -1;
 
 	BI_CTX *ctx = rsa_ctx->bi_ctx;
-	bigint *mod = rsa_ctx->m;
-	bigint *expn = rsa_ctx->e;
 	bigint *cert_sig = NULL;
-	bigint *mod_clone = bi_clone(ctx, mod);
-	if (mod_clone == NULL)
-		return -1;
-	bigint *expn_clone = bi_clone(ctx, expn);
-	if (expn_clone == NULL)
-		return -1;
-	int sig_ver_res =
-		sig_verify(ctx, signature, signature_size, mod_clone, expn_clone, &cert_sig);
+	int sig_ver_res = sig_verify(rsa_ctx, signature, signature_size, &cert_sig);
 
 	if ((sig_ver_res == 0) && (cert_sig != NULL) && payload_digest) {
 		int cmp_status = (bi_compare(cert_sig, payload_digest) != 0);
@@ -352,10 +443,54 @@ static int check_header(const sbimghdr_t *sbimg)
 {
 	CHECK_NULL(sbimg);
 
+	STEP_START(start);
+
 	sbimghdr_t _sbimg;
 	sb_mem.cpy_func((void *)&_sbimg, (size_t)sbimg, HEADER_SIZE);
 	memset_s((void *)_sbimg.h_dgst, 0, SHA_DIGEST_LEN);
-	return check_digest((uint8_t *)(&_sbimg), HEADER_SIZE, (uint8_t *)sbimg->h_dgst);
+	int ret = check_digest((uint8_t *)(&_sbimg), HEADER_SIZE, (uint8_t *)sbimg->h_dgst);
+
+	STEP_END(BOOTSTAGE_OBJ_HEADER_HASH, start);
+
+	return ret;
+}
+
+static void header_digest(const sbimghdr_t *sbimg, uint8_t *digest)
+{
+	SHA256_CTX sha256_ctx;
+
+	SHA256_Init(&sha256_ctx);
+	SHA256_Update(&sha256_ctx, (const uint8_t *)sbimg, HEADER_SIZE);
+	SHA256_Final(digest, &sha256_ctx);
+}
+
+static void verified_add(const sbimghdr_t *sbimg, const uint8_t *payload_dgst)
+{
+	if (verified_reuse || verified_count >= SBIMG_VERIFIED_MAX_OBJECTS)
+		return;
+
+	verified_obj_t *obj = &verified[verified_count++];
+
+	obj->offset = sb_mem.image_offset;
+	header_digest(sbimg, obj->header_dgst);
+	if (payload_dgst)
+		memcpy(obj->payload_dgst, payload_dgst, SHA_DIGEST_LEN);
+}
+
+// Return the check pass record of the current object if its header is unchanged, or NULL
+static const verified_obj_t *verified_next(const sbimghdr_t *sbimg)
+{
+	uint8_t digest[SHA_DIGEST_LEN];
+
+	if (!verified_reuse || verified_index >= verified_count ||
+	    verified[verified_index].offset != sb_mem.image_offset)
+		return NULL;
+
+	header_digest(sbimg, digest);
+	if (memcmp(digest, verified[verified_index].header_dgst, SHA_DIGEST_LEN))
+		return NULL;
+
+	return &verified[verified_index++];
 }
 
 static int derrived_key(uint8_t *cek, size_t size)
@@ -413,16 +548,60 @@ end:
 	return status;
 }
 
-static int decrypt(uint8_t *data, int size)
+// DUK is cleared in the OTP dump of the stages after SBL-S2
+static bool duk_available(void)
 {
-	CHECK_NULL(data);
+	uint8_t bits = 0;
+
+	for (int i = 0; i < AES_KEY_LEN; i++)
+		bits |= sb_mem.otp->duk[i];
+
+	return bits != 0;
+}
+
+static int decrypt_init(struct AES_ctx *aes_ctx)
+{
+	CHECK_NULL(aes_ctx);
+
+	int status = 0;
+
+	STEP_START(start);
+
+	if (!cek_valid || cek_key_number != key_number ||
+	    memcmp(cek_encrypted_key, encrypted_key, AES_KEY_LEN)) {
+		uint8_t cek[AES_KEY_LEN];
+
+		cek_valid = false;
+		CHECK_OK(-EDATASIZE, derrived_key(cek, AES_KEY_LEN));
+		AES_init_ctx_iv(&cek_ctx, cek, iv);
+		memset_s(cek, 0, AES_KEY_LEN);
+
+		memcpy(cek_encrypted_key, encrypted_key, AES_KEY_LEN);
+		cek_key_number = key_number;
+		cek_valid = true;
+	}
+
+	// IV of the cached context is never advanced
+	memcpy(aes_ctx, &cek_ctx, sizeof(*aes_ctx));
+
+end:
+	STEP_END(BOOTSTAGE_OBJ_AES_DECRYPT, start);
+	return status;
+}
+
+static int verify_hash(const uint8_t *digest, const uint8_t *signature, int index)
+{
+	CHECK_NULL(digest);
+	CHECK_NULL(signature);
 
 	int status = 0;
 
-	uint8_t cek[AES_KEY_LEN];
-	CHECK_OK(-EDATASIZE, derrived_key(cek, AES_KEY_LEN));
-	AES_CBC_decrypt_buffer_wrap(data, data, size, cek, iv);
-	memset_s(cek, 0, AES_KEY_LEN);
+	CHECK_OK(ESBIMGBOOT_NON_ROOT_CERT_X509_ERR, (index < 0) || (index > cert_index));
+	CHECK_OK(-ENULL, non_root_cert[index] == NULL || non_root_cert[index]->rsa_ctx == NULL);
+
+	CHECK_OK(ESBIMGBOOT_PAYLOAD_BAD_SIGNATURE,
+	         signature_verify_hash(digest, signature, RSA_MOD_LEN,
+	                               non_root_cert[index]->rsa_ctx));
 
 end:
 	return status;
@@ -446,83 +625,531 @@ end:
 	return status;
 }
 
-static int image_handle(const sbimghdr_t *sbimg, bool update)
+static const uint8_t *image_map(uintptr_t offset, size_t size)
 {
-	CHECK_NULL(sbimg);
+	if (!sb_mem.map_img_func)
+		return NULL;
+
+	return (const uint8_t *)sb_mem.map_img_func(offset, size);
+}
+
+static int read_chunk_wait(void)
+{
+	int ret = 0;
+
+	if (!sb_mem.read_start_func || !sb_mem.read_poll_func)
+		return 0;
+
+#if defined(BOOTSTAGE_ENABLE)
+	uint64_t start = timer_get_us();
+#endif
+
+	do {
+		ret = sb_mem.read_poll_func();
+	} while (ret > 0);
+
+#if defined(BOOTSTAGE_ENABLE)
+	uint64_t duration = timer_get_us() - start;
+
+	bootstage_add_duration(BOOTSTAGE_ID_SBL_S2_LOAD_FLASH_WAIT, duration);
+	bootstage_obj_add_duration(BOOTSTAGE_OBJ_FLASH_READ, duration);
+#endif
+
+	return ret;
+}
+
+// Finish filling of the readahead window, it's dropped if background reading fails
+static void readahead_wait(void)
+{
+	if (!readahead.pending)
+		return;
+
+	readahead.pending = false;
+	if (read_chunk_wait())
+		readahead.len = 0;
+}
+
+// Return pointer to the data if the readahead window holds it, or NULL
+static const uint8_t *readahead_find(uintptr_t offset, size_t size)
+{
+	uintptr_t delta = offset - readahead.offset;
+
+	if (readahead.pending || delta > readahead.len || size > readahead.len - delta)
+		return NULL;
+
+	return readahead.buf + delta;
+}
+
+/**
+ * Return pointer to the data in the readahead window, the window is refilled from offset
+ * if it doesn't hold the data. NULL is returned for data larger than the window and if the
+ * window can't be read, e.g. it goes beyond the end of the image. The pointer is valid until
+ * the next reading of the image.
+ */
+static const uint8_t *readahead_get(uintptr_t offset, size_t size)
+{
+	const uint8_t *data;
+
+	if (size > SBIMG_READAHEAD_SIZE)
+		return NULL;
+
+	readahead_wait();
+	data = readahead_find(offset, size);
+	if (data)
+		return data;
+
+	readahead.offset = offset;
+	readahead.len = SBIMG_READAHEAD_SIZE;
+	if (sb_mem.read_img_func(readahead.buf, offset, SBIMG_READAHEAD_SIZE)) {
+		readahead.len = 0;
+		return NULL;
+	}
+
+	return readahead.buf;
+}
+
+// Start filling of the readahead window from offset in background
+static void readahead_start(uintptr_t offset)
+{
+	if (!sb_mem.read_start_func || !sb_mem.read_poll_func || readahead.pending ||
+	    readahead_find(offset, HEADER_SIZE))
+		return;
+
+	readahead.offset = offset;
+	readahead.len = SBIMG_READAHEAD_SIZE;
+	readahead.pending = true;
+	if (sb_mem.read_start_func(readahead.buf, offset, SBIMG_READAHEAD_SIZE) < 0) {
+		readahead.len = 0;
+		readahead.pending = false;
+	}
+}
+
+// Copy the beginning of the data held by the readahead window, return the copied size
+static size_t readahead_copy(uint8_t *buf, uintptr_t offset, size_t size)
+{
+	uintptr_t delta = offset - readahead.offset;
+	size_t len;
+
+	if (readahead.pending || delta >= readahead.len)
+		return 0;
+
+	len = MIN(size, readahead.len - delta);
+	memcpy(buf, readahead.buf + delta, len);
+
+	return len;
+}
+
+static int image_fetch(void *buf, uintptr_t offset, size_t size)
+{
+	const uint8_t *data = readahead_get(offset, size);
+
+	if (!data)
+		return sb_mem.read_img_func(buf, offset, size);
+
+	memcpy(buf, data, size);
+
+	return 0;
+}
+
+static int image_read(void *buf, uintptr_t offset, size_t size)
+{
+	STEP_START(start);
+
+	int ret = image_fetch(buf, offset, size);
+
+	STEP_END(BOOTSTAGE_OBJ_FLASH_READ, start);
+
+	return ret;
+}
+
+// Signature and data of small objects are used right from the readahead window
+static const uint8_t *image_window(uintptr_t offset, size_t size)
+{
+	STEP_START(start);
+
+	const uint8_t *data = readahead_get(offset, size);
+
+	STEP_END(BOOTSTAGE_OBJ_FLASH_READ, start);
+
+	return data;
+}
+
+// Copy the certificate to the store, as the image data it's parsed from is transient
+static const uint8_t *cert_keep(const uint8_t *data, size_t size)
+{
+	uint8_t *der = cert_store + cert_store_used;
+
+	if (size > sizeof(cert_store) - cert_store_used)
+		return NULL;
+
+	sb_mem.cpy_func(der, (uintptr_t)data, size);
+	cert_store_used += size;
+
+	return der;
+}
+
+static size_t object_size(const sbimghdr_t *sbimg)
+{
+	size_t sign_size = (sbimg->flags_bits.signed_obj) ? RSA_MOD_LEN : 0;
+	size_t image_size = HEADER_SIZE + sign_size + sbimg->pl_size;
+
+	return (sbimg->flags_bits.encrypted) ? COMPLETE_BLOCK_LENGTH(image_size) :
+	                                       ALIGN(image_size, 4);
+}
+
+static int read_header(sbimghdr_t *sbimg)
+{
+	const uint8_t *header = image_map(sb_mem.image_offset, HEADER_SIZE);
+	int ret = 0;
+
+	// Header prefetched while the previous payload was processed is waited for by it
+	readahead_wait();
+
+	STEP_START(start);
 
+	if (header)
+		sb_mem.cpy_func(sbimg, (uintptr_t)header, HEADER_SIZE);
+	else
+		ret = image_fetch(sbimg, sb_mem.image_offset, HEADER_SIZE);
+
+#if defined(BOOTSTAGE_ENABLE)
+	// Record is started for anything looking like an object, the chain ends with garbage
+	if (!ret && sbimg->h_id == SBIMG_HEADER_MAGIC) {
+		bootstage_obj_start(sb_mem.image_offset, sbimg->flags, sbimg->pl_size);
+		STEP_END(BOOTSTAGE_OBJ_FLASH_READ, start);
+	}
+#endif
+
+	return ret;
+}
+
+static int read_chunk_start(uint8_t *buf, uintptr_t offset, size_t size)
+{
+	// Start of the payload is usually read ahead together with its header
+	size_t head = readahead_copy(buf, offset, size);
+
+	if (head == size)
+		return 0;
+
+	buf += head;
+	offset += head;
+	size -= head;
+
+	if (sb_mem.read_start_func && sb_mem.read_poll_func)
+		return (sb_mem.read_start_func(buf, offset, size) < 0) ? -EINTERNAL : 0;
+
+	return image_read(buf, offset, size);
+}
+
+/*
+ * Each block of the slice is read into the stack once, hashed before (sign_of_encrypted) or after
+ * deciphering and written back, so the payload memory is read and written once.
+ */
+static void slice_decrypt_hash(uint8_t *slice, size_t len, size_t hash_len,
+                               SHA256_CTX *sha256_ctx, struct AES_ctx *aes_ctx,
+                               bool sign_of_encrypted)
+{
+	uint32_t block[SBIMG_FUSED_BLOCK / sizeof(uint32_t)];
+	uint8_t *data = (uint8_t *)block;
+
+	for (size_t offset = 0; offset < len; offset += sizeof(block)) {
+		size_t size = MIN(len - offset, sizeof(block));
+		size_t block_hash_len = (offset < hash_len) ? MIN(hash_len - offset, size) : 0;
+
+		memcpy(data, slice + offset, size);
+
+		if (sign_of_encrypted)
+			SHA256_Update(sha256_ctx, data, block_hash_len);
+
+#if defined(BOOTSTAGE_ENABLE)
+		uint64_t ticks = timer_get_ticks();
+#endif
+
+		AES_CBC_decrypt_buffer(aes_ctx, data, size);
+
+#if defined(BOOTSTAGE_ENABLE)
+		aes_ticks += timer_get_ticks() - ticks;
+#endif
+
+		if (!sign_of_encrypted)
+			SHA256_Update(sha256_ctx, data, block_hash_len);
+
+		memcpy(slice + offset, data, size);
+	}
+
+	memset_s(block, 0, sizeof(block));
+}
+
+static void chunk_process(uint8_t *buf, size_t size, size_t hash_len, SHA256_CTX *sha256_ctx,
+                          struct AES_ctx *aes_ctx, bool sign_of_encrypted)
+{
+#if defined(BOOTSTAGE_ENABLE)
+	uint64_t start = timer_get_us();
+
+	aes_ticks = 0;
+#endif
+
+	for (size_t offset = 0; offset < size; offset += SBIMG_POLL_SLICE) {
+		uint8_t *slice = buf + offset;
+		size_t len = MIN(size - offset, (size_t)SBIMG_POLL_SLICE);
+		size_t slice_hash_len = (offset < hash_len) ? MIN(hash_len - offset, len) : 0;
+
+		// Unverified plain data is wiped by the caller if the digest doesn't match
+		if (aes_ctx)
+			slice_decrypt_hash(slice, len, slice_hash_len, sha256_ctx, aes_ctx,
+			                   sign_of_encrypted);
+		else
+			SHA256_Update(sha256_ctx, slice, slice_hash_len);
+
+		// Errors are reported by read_chunk_wait()
+		if (sb_mem.read_start_func && sb_mem.read_poll_func)
+			sb_mem.read_poll_func();
+	}
+
+#if defined(BOOTSTAGE_ENABLE)
+	uint64_t duration = timer_get_us() - start;
+	uint64_t aes_us = MIN(timer_ticks_to_us(aes_ticks), duration);
+
+	bootstage_add_duration(BOOTSTAGE_ID_SBL_S2_LOAD_PROCESS, duration);
+	bootstage_obj_add_duration(BOOTSTAGE_OBJ_AES_DECRYPT, aes_us);
+	bootstage_obj_add_duration(BOOTSTAGE_OBJ_PAYLOAD_HASH, duration - aes_us);
+#endif
+}
+
+/**
+ * Decompress the next piece of payload to the load address. The load region is checked
+ * as soon as the frame header gives the decompressed size.
+ */
+static int payload_decompress(lz4_stream_t *lz4, const sbimghdr_t *sbimg, const uint8_t *src,
+                              size_t len)
+{
 	int status = 0;
-	size_t size;
 
-	enum act { verification, decipher, check, nope };
-	enum act chain[] = { nope, nope, nope };
+	STEP_START(start);
+
+	while (len) {
+		bool header = lz4_stream_has_header(lz4);
+		int ret = lz4_stream_decode(lz4, src, len);
 
-	chain[0] = (sbimg->flags_bits.encrypted) ? decipher : nope;
-	chain[1] = (sbimg->flags_bits.checksum) ? check : nope;
-	chain[2] = (sbimg->flags_bits.signed_obj) ? verification : nope;
+		CHECK_OK(ESBIMGBOOT_PAYLOAD_BAD_COMPRESSION, ret < 0);
+		if (!header && lz4_stream_has_header(lz4))
+			CHECK_OK(-EINVALIDDATA,
+			         sb_mem.chck_laddr_func(sbimg->l_addr, lz4->dst_size));
 
-	if (sbimg->flags_bits.sign_of_encrypted) {
-		chain[0] = verification;
-		chain[2] = decipher;
+		src += ret;
+		len -= ret;
 	}
 
+end:
+	STEP_END(BOOTSTAGE_OBJ_DECOMPRESS, start);
+
+	return status;
+}
+
+// Decompress the whole payload to the heap for chck_img callback
+static int payload_unpack(lz4_stream_t *lz4, const uint8_t *src, size_t len)
+{
+	int status = 0;
+
+	lz4_stream_init(lz4, NULL);
+
+	int ret = lz4_stream_decode(lz4, src, len);
+	CHECK_OK(ESBIMGBOOT_PAYLOAD_BAD_COMPRESSION, ret < 0 || !lz4_stream_has_header(lz4));
+
+	lz4->dst = (uint8_t *)malloc(lz4->dst_size);
+	CHECK_OK(ESBIMGBOOT_MALLOC_ERR, lz4->dst == NULL && lz4->dst_size);
+
+	CHECK_OK(ESBIMGBOOT_PAYLOAD_BAD_COMPRESSION,
+	         lz4_stream_decode(lz4, src + ret, len - ret) < 0 || !lz4_stream_done(lz4));
+
+end:
+	return status;
+}
+
+/**
+ * Payload is read by SBIMG_CHUNK_SIZE pieces. While a piece is hashed and deciphered,
+ * the next one is read in background if sb_mem provides read_start_func/read_poll_func.
+ * While the last piece is processed, the header of the next object is read ahead the same way.
+ * Hash covers the ciphertext for sign_of_encrypted images and the plain data otherwise.
+ * On the check pass only two chunks are kept in memory, unless chck_img callback needs
+ * the whole payload. Plain payload is hashed right from the flash on the check pass
+ * if sb_mem provides map_img_func. Payload covered by a manifest is accepted if its digest
+ * matches manifest_entry, the signature is checked only if the payload has it.
+ * Payload verified by the check pass is accepted if its digest matches verified_dgst.
+ * Compressed payload goes through the heap buffers and is decompressed to the load address
+ * on the update pass, on the check pass it's decompressed only for chck_img callback.
+ * Ciphertext hashed for sign_of_encrypted images isn't deciphered on the check pass unless
+ * chck_img callback needs the plain data, so it's verified without DUK.
+ * Size of the data placed at the load address is returned in load_size on the update pass,
+ * it's the decompressed size for compressed payload.
+ */
+static int image_handle(const sbimghdr_t *sbimg, bool update, const uint8_t *manifest_entry,
+                        const uint8_t *verified_dgst, size_t *load_size)
+{
+	CHECK_NULL(sbimg);
+
+	int status = 0;
+
+	bool sign_of_encrypted = sbimg->flags_bits.sign_of_encrypted;
+	bool decipher = sbimg->flags_bits.encrypted &&
+	                (update || !sign_of_encrypted || sb_mem.chck_img);
+	bool check = sbimg->flags_bits.checksum;
+	bool decompress = sbimg->flags_bits.compressed;
+	bool verification = !verified_dgst && (sbimg->flags_bits.signed_obj ||
+	                                       (sign_of_encrypted && !manifest_entry));
+
 	size_t data_size = sbimg->pl_size;
 	size_t cipher_size = COMPLETE_BLOCK_LENGTH(data_size);
 	size_t pl_size = (sbimg->flags_bits.encrypted) ? cipher_size : data_size;
 	size_t sign_size = (sbimg->flags_bits.signed_obj) ? RSA_MOD_LEN : 0;
+	size_t hash_size = (sign_of_encrypted) ? pl_size : data_size;
+	size_t chunk_size = MIN(pl_size, (size_t)SBIMG_CHUNK_SIZE);
 
 	uintptr_t data = (uintptr_t)(sb_mem.image_offset + HEADER_SIZE + sign_size);
-	uint8_t *signature = NULL;
+	const uint8_t *mapped = NULL;
+	const uint8_t *signature = NULL;
+	uint8_t *sig_buf = NULL;
 	uint8_t *l_addr = NULL;
+	uint8_t *chunk = NULL;
 
-	if (sign_size) {
-		signature = (uint8_t *)malloc(sign_size);
-		CHECK_OK(-ENULL, signature == NULL);
+	uint8_t digest[SHA_DIGEST_LEN];
+	SHA256_CTX sha256_ctx;
+	struct AES_ctx aes_ctx;
+	lz4_stream_t lz4;
+
+	lz4_stream_init(&lz4, (update) ? (uint8_t *)(uintptr_t)sbimg->l_addr : NULL);
+
+	// Chunks go one by one to the load address or alternate between two heap buffers
+#define CHUNK_BUF(offset) \
+	((l_addr) ? l_addr + (offset) : chunk + (((offset) / chunk_size) % 2) * chunk_size)
+
+	// Mapped payload and signature stay valid as nothing is read by read_img_func
+	if (!update && !decipher && !sb_mem.chck_img)
+		mapped = image_map(sb_mem.image_offset + HEADER_SIZE, sign_size + pl_size);
+
+	if (mapped) {
+		signature = mapped;
+	} else if (sign_size && verification) {
+		sig_buf = (uint8_t *)malloc(sign_size);
+		CHECK_OK(-ENULL, sig_buf == NULL);
 		CHECK_OK(-EINTERNAL,
-		         sb_mem.read_img_func(signature, sb_mem.image_offset + HEADER_SIZE,
-		                              sign_size));
+		         image_read(sig_buf, sb_mem.image_offset + HEADER_SIZE, sign_size));
+		signature = sig_buf;
 	}
 
-	if (!update) {
+	if (update && !decompress) {
+		l_addr = (uint8_t *)(uintptr_t)sbimg->l_addr;
+	} else if (!update && sb_mem.chck_img) {
 		l_addr = (uint8_t *)malloc(pl_size);
 		CHECK_OK(-ENULL, l_addr == NULL);
-	} else
-		l_addr = (uint8_t *)sbimg->l_addr;
-
-	CHECK_OK(-EINTERNAL, sb_mem.read_img_func(l_addr, data, pl_size));
-
-	for (size_t i = 0; i < sizeof(chain) / sizeof(chain[0]); i++) {
-		switch (chain[i]) {
-		case verification:
-			size = (sbimg->flags_bits.sign_of_encrypted) ? cipher_size : data_size;
-			CHECK_OK(ESBIMGBOOT_PAYLOAD_BAD_SIGNATURE,
-			         verify(l_addr, signature, size, cert_index));
-			break;
-
-		case decipher:
-			CHECK_OK(-EINVALIDDATA, decrypt(l_addr, cipher_size));
-			break;
-
-		case check:
-			size = (sbimg->flags_bits.sign_of_encrypted) ? cipher_size : data_size;
-			CHECK_OK(ESBIMGBOOT_PAYLOAD_BAD_HASH,
-			         check_digest(l_addr, size, (uint8_t *)sbimg->pl_dgst));
-			break;
-
-		default:
-			break;
+	} else if (!mapped) {
+		chunk = (uint8_t *)malloc(2 * chunk_size);
+		CHECK_OK(-ENULL, chunk == NULL);
+	}
+
+	if (decipher) {
+		CHECK_OK(ESBIMGBOOT_ENC_KEY_UNAVAILABLE, !duk_available());
+		CHECK_OK(-EINVALIDDATA, decrypt_init(&aes_ctx));
+	}
+
+	SHA256_Init(&sha256_ctx);
+
+	if (mapped) {
+		STEP_START(start);
+		SHA256_Update(&sha256_ctx, mapped + sign_size, hash_size);
+		STEP_END(BOOTSTAGE_OBJ_PAYLOAD_HASH, start);
+	} else if (pl_size)
+		CHECK_OK(-EINTERNAL, read_chunk_start(CHUNK_BUF(0), data, chunk_size));
+
+	for (size_t offset = 0; !mapped && offset < pl_size; offset += chunk_size) {
+		size_t size = MIN(pl_size - offset, chunk_size);
+		size_t hash_len = (offset < hash_size) ? MIN(hash_size - offset, size) : 0;
+		size_t next = offset + chunk_size;
+
+		CHECK_OK(-EINTERNAL, read_chunk_wait());
+
+		if (next < pl_size)
+			CHECK_OK(-EINTERNAL, read_chunk_start(CHUNK_BUF(next), data + next,
+			                                      MIN(pl_size - next, chunk_size)));
+		else
+			readahead_start(sb_mem.image_offset + object_size(sbimg));
+
+		chunk_process(CHUNK_BUF(offset), size, hash_len, &sha256_ctx,
+		              (decipher) ? &aes_ctx : NULL, sign_of_encrypted);
+
+		// Padding of the ciphertext isn't a part of the frame
+		if (update && decompress) {
+			size_t len = (offset < data_size) ? MIN(data_size - offset, size) : 0;
+			int ret = payload_decompress(&lz4, sbimg, CHUNK_BUF(offset), len);
+			CHECK_OK(ret, ret != 0);
 		}
 	}
 
+	SHA256_Final(digest, &sha256_ctx);
+
+	if (verification && sign_of_encrypted)
+		CHECK_OK(ESBIMGBOOT_PAYLOAD_BAD_SIGNATURE,
+		         verify_hash(digest, signature, cert_index));
+
+	if (check)
+		CHECK_OK(ESBIMGBOOT_PAYLOAD_BAD_HASH,
+		         memcmp(digest, sbimg->pl_dgst, SHA_DIGEST_LEN));
+
+	if (manifest_entry)
+		CHECK_OK(ESBIMGBOOT_PAYLOAD_BAD_MANIFEST_HASH,
+		         memcmp(digest, manifest_entry, SHA_DIGEST_LEN));
+
+	if (verification && !sign_of_encrypted)
+		CHECK_OK(ESBIMGBOOT_PAYLOAD_BAD_SIGNATURE,
+		         verify_hash(digest, signature, cert_index));
+
+	if (verified_dgst)
+		CHECK_OK(ESBIMGBOOT_PAYLOAD_BAD_HASH,
+		         memcmp(digest, verified_dgst, SHA_DIGEST_LEN));
+
+	if (update && decompress)
+		CHECK_OK(ESBIMGBOOT_PAYLOAD_BAD_COMPRESSION, !lz4_stream_done(&lz4));
+
+	if (update && load_size)
+		*load_size = (decompress) ? lz4.dst_size : data_size;
+
+	if (!update)
+		verified_add(sbimg, digest);
+
+#undef CHUNK_BUF
+
 end:
-	if (status)
-		memset_s(l_addr, 0, pl_size);
-	else if (sb_mem.chck_img)
+	// Nothing is left reading in background when the object is handled
+	readahead_wait();
+
+	if (decipher)
+		memset_s(&aes_ctx, 0, sizeof(aes_ctx));
+
+	if (status) {
+		if (l_addr)
+			memset_s(l_addr, 0, pl_size);
+		if (update && decompress)
+			memset_s(lz4.dst, 0, lz4.dst_pos);
+	} else if (sb_mem.chck_img && decompress) {
+		// Check pass keeps the compressed payload only
+		if (!update)
+			status = payload_unpack(&lz4, l_addr, data_size);
+		if (!status)
+			status = sb_mem.chck_img(lz4.dst, lz4.dst_size);
+	} else if (sb_mem.chck_img) {
 		status = sb_mem.chck_img(l_addr, pl_size);
+	}
 
 	if (!update && l_addr)
 		free(l_addr);
-	if (signature)
-		free(signature);
+	if (!update && lz4.dst)
+		free(lz4.dst);
+	if (chunk) {
+		memset_s(chunk, 0, 2 * chunk_size);
+		free(chunk);
+	}
+	if (sig_buf)
+		free(sig_buf);
 
 	return status;
 }
@@ -541,10 +1168,26 @@ static void crypto_free(void)
 		x509_root = NULL;
 	}
 
+	// No bigint context is left, so the arena is reset in bulk
+	bi_arena_reset();
+
 	cert_index = 0;
 	end_cert_has_been_handled = 0;
 
+	manifest_count = 0;
+	manifest_index = 0;
+	memset_s(manifest_dgst, 0, sizeof(manifest_dgst));
+
+	cek_valid = false;
+	memset_s(&cek_ctx, 0, sizeof(cek_ctx));
+
 	memset_s(sign_cert_arr, 0, sizeof(sign_cert_arr));
+
+	cert_store_used = 0;
+
+	verified_count = 0;
+	verified_index = 0;
+	verified_reuse = false;
 }
 
 static int check_end_cert_load_requirement(sbimghdr_t *header)
@@ -580,6 +1223,44 @@ end:
 	return status;
 }
 
+static int manifest_handle(sbimghdr_t *header, const uint8_t *data, const uint8_t *signature)
+{
+	int status = 0;
+	int num = 0;
+
+	CHECK_OK(ESBIMGBOOT_PAYLOAD_BAD_CERT_CHAIN, check_end_cert_load_requirement(header));
+
+	// The manifest replaces signatures of the payloads, so it's always signed
+	CHECK_OK(ESBIMGBOOT_MANIFEST_IS_NOT_SIGNED, !header->flags_bits.signed_obj);
+	CHECK_OK(ESBIMGBOOT_MANIFEST_BAD_SIZE,
+	         header->flags_bits.encrypted || !header->pl_size ||
+	                 (header->pl_size % SHA_DIGEST_LEN) ||
+	                 (header->pl_size > sizeof(manifest_dgst)));
+
+	SET_CERT_NUMBER(header->sign_cert_id, num);
+
+	// Digests are verified in RAM, the flash may change after they are read
+	manifest_count = 0;
+	manifest_index = 0;
+	sb_mem.cpy_func((void *)manifest_dgst, (uintptr_t)data, header->pl_size);
+	CHECK_OK(ESBIMGBOOT_MANIFEST_BAD_SIGNATURE,
+	         verify((const uint8_t *)manifest_dgst, signature, header->pl_size, num));
+
+	manifest_count = header->pl_size / SHA_DIGEST_LEN;
+
+end:
+	return status;
+}
+
+// Return digest of the next payload or NULL if it isn't covered by a manifest
+static const uint8_t *manifest_next(void)
+{
+	if (manifest_index >= manifest_count)
+		return NULL;
+
+	return manifest_dgst[manifest_index++];
+}
+
 int sblimg_init(sb_mem_t *sb_ctx)
 {
 	int status = ESBIMGBOOT_NO_ERR;
@@ -587,6 +1268,12 @@ int sblimg_init(sb_mem_t *sb_ctx)
 	memset((void *)&sb_mem, 0, sizeof(sb_mem));
 	sb_mem = *sb_ctx;
 
+	// Image may be changed between the passes
+	readahead.len = 0;
+	readahead.pending = false;
+	memset((void *)&exec_header, 0, sizeof(exec_header));
+	exec_size = 0;
+
 	sb_mem.otp = otp_get_dump();
 	CHECK_OK(-ENULL, sb_mem.otp == NULL);
 
@@ -599,11 +1286,14 @@ int sblimg_check(void)
 	int status = ESBIMGBOOT_NO_ERR;
 	sbimghdr_t sbimg;
 
-	uint8_t *data = NULL;
-	uint8_t *signature = NULL;
+	const uint8_t *mapped = NULL;
+	const uint8_t *manifest_entry = NULL;
+	const uint8_t *data = NULL;
+	const uint8_t *signature = NULL;
+	uint8_t *data_buf = NULL;
+	uint8_t *sig_buf = NULL;
 
-	CHECK_OK(-EINTERNAL,
-	         sb_mem.read_img_func((void *)&sbimg, sb_mem.image_offset, HEADER_SIZE));
+	CHECK_OK(-EINTERNAL, read_header(&sbimg));
 
 	CHECK_OK(ESBIMGBOOT_IMAGE_BAD_HEADER_ID, sbimg.h_id != SBIMG_HEADER_MAGIC);
 
@@ -611,27 +1301,44 @@ int sblimg_check(void)
 	size_t cipher_size = COMPLETE_BLOCK_LENGTH(data_size);
 	size_t pl_size = (sbimg.flags_bits.encrypted) ? cipher_size : data_size;
 	size_t sign_size = (sbimg.flags_bits.signed_obj) ? RSA_MOD_LEN : 0;
-	size_t image_size = HEADER_SIZE + sign_size + data_size;
-	image_size = (sbimg.flags_bits.encrypted) ? COMPLETE_BLOCK_LENGTH(image_size) :
-	                                            ALIGN(image_size, 4);
+	size_t image_size = object_size(&sbimg);
 
 	if (sbimg.flags_bits.obj_type == SBIMAGE_TYPE_ROOT_CERTIFICATE ||
 	    sbimg.flags_bits.obj_type == SBIMAGE_TYPE_NON_ROOT_CERTIFICATE ||
-	    sbimg.flags_bits.obj_type == SBIMAGE_TYPE_ENCRYPTION_KEY) {
-		data = (uint8_t *)malloc(data_size);
-		CHECK_OK(-ENULL, data == NULL);
-		CHECK_OK(-EINTERNAL,
-		         sb_mem.read_img_func((void *)data,
-		                              sb_mem.image_offset + HEADER_SIZE + sign_size,
-		                              data_size));
+	    sbimg.flags_bits.obj_type == SBIMAGE_TYPE_ENCRYPTION_KEY ||
+	    sbimg.flags_bits.obj_type == SBIMAGE_TYPE_MANIFEST) {
+		// Signature and data are used right from the flash if it's memory-mapped
+		mapped = image_map(sb_mem.image_offset + HEADER_SIZE, sign_size + data_size);
+		if (!mapped)
+			mapped = image_window(sb_mem.image_offset + HEADER_SIZE,
+			                      sign_size + data_size);
+		if (mapped) {
+			signature = mapped;
+			data = mapped + sign_size;
+		} else {
+			data_buf = (uint8_t *)malloc(data_size);
+			CHECK_OK(-ENULL, data_buf == NULL);
+			CHECK_OK(-EINTERNAL,
+			         image_read(data_buf, sb_mem.image_offset + HEADER_SIZE + sign_size,
+			                    data_size));
+			data = data_buf;
+		}
+	}
+
+	if (sbimg.flags_bits.obj_type == SBIMAGE_TYPE_ROOT_CERTIFICATE ||
+	    sbimg.flags_bits.obj_type == SBIMAGE_TYPE_NON_ROOT_CERTIFICATE) {
+		data = cert_keep(data, data_size);
+		CHECK_OK(ESBIMGBOOT_MALLOC_ERR, data == NULL);
 	}
 
-	if (sbimg.flags_bits.obj_type == SBIMAGE_TYPE_ENCRYPTION_KEY && sign_size) {
-		signature = (uint8_t *)malloc(sign_size);
-		CHECK_OK(-ENULL, signature == NULL);
+	if (!mapped && sign_size &&
+	    (sbimg.flags_bits.obj_type == SBIMAGE_TYPE_ENCRYPTION_KEY ||
+	     sbimg.flags_bits.obj_type == SBIMAGE_TYPE_MANIFEST)) {
+		sig_buf = (uint8_t *)malloc(sign_size);
+		CHECK_OK(-ENULL, sig_buf == NULL);
 		CHECK_OK(-EINTERNAL,
-		         sb_mem.read_img_func((void *)signature, sb_mem.image_offset + HEADER_SIZE,
-		                              sign_size));
+		         image_read(sig_buf, sb_mem.image_offset + HEADER_SIZE, sign_size));
+		signature = sig_buf;
 	}
 
 	CHECK_HEADER(&sbimg);
@@ -649,6 +1356,8 @@ int sblimg_check(void)
 		CHECK_OK(ESBIMGBOOT_ROOT_CERT_BAD_HASH,
 		         memcmp((const void *)sb_mem.otp->rotpk,
 		                (const void *)x509_root->sha256_digest, SHA_DIGEST_LEN));
+
+		verified_add(&sbimg, NULL);
 		break;
 
 	case SBIMAGE_TYPE_NON_ROOT_CERTIFICATE:
@@ -689,6 +1398,8 @@ int sblimg_check(void)
 
 		if (!end_cert_has_been_handled)
 			cert_index++;
+
+		verified_add(&sbimg, NULL);
 		break;
 
 	case SBIMAGE_TYPE_ENCRYPTION_KEY:
@@ -698,22 +1409,35 @@ int sblimg_check(void)
 
 		int num = 0;
 		SET_CERT_NUMBER(sbimg.sign_cert_id, num);
-		CHECK_OK(ESBIMGBOOT_ENC_KEY_BAD_SIGNATURE, verify(data, signature, data_size, num));
+		CHECK_OK(-EDATASIZE, data_size > AES_KEY_LEN);
 
-		sb_mem.cpy_func((void *)encrypted_key, (size_t)data, cipher_size);
+		// Key is verified in RAM, the flash may change after it's read
+		memset((void *)encrypted_key, 0, AES_KEY_LEN);
+		sb_mem.cpy_func((void *)encrypted_key, (uintptr_t)data, data_size);
+		CHECK_OK(ESBIMGBOOT_ENC_KEY_BAD_SIGNATURE,
+		         verify(encrypted_key, signature, data_size, num));
 		key_number = sbimg.aes_key_num;
 		break;
 
+	case SBIMAGE_TYPE_MANIFEST: {
+		int ret = manifest_handle(&sbimg, data, signature);
+		CHECK_OK(ret, ret != 0);
+		break;
+	}
+
 	case SBIMAGE_TYPE_PAYLOAD_NO_EXEC:
 	case SBIMAGE_TYPE_PAYLOAD_NO_RETURN:
 	case SBIMAGE_TYPE_PAYLOAD_WITH_RETURN:
 		CHECK_OK(ESBIMGBOOT_PAYLOAD_BAD_CERT_CHAIN,
 		         check_end_cert_load_requirement(&sbimg));
-		CHECK_OK(ESBIMGBOOT_PAYLOAD_IS_NOT_SIGNED, check_signed_load_requirement(&sbimg));
+		manifest_entry = manifest_next();
+		if (!manifest_entry)
+			CHECK_OK(ESBIMGBOOT_PAYLOAD_IS_NOT_SIGNED,
+			         check_signed_load_requirement(&sbimg));
 		CHECK_OK(ESBIMGBOOT_PAYLOAD_IS_NOT_ENCRYPTED,
 		         check_encrypted_load_requirement(&sbimg));
 
-		int ret = image_handle(&sbimg, false);
+		int ret = image_handle(&sbimg, false, manifest_entry, NULL, NULL);
 		CHECK_OK(ret, ret != 0);
 		CHECK_OK(ESBIMGBOOT_LOAD_FINISH,
 		         sbimg.flags_bits.obj_type == SBIMAGE_TYPE_PAYLOAD_NO_RETURN);
@@ -727,10 +1451,10 @@ int sblimg_check(void)
 	sb_mem.image_offset += image_size;
 
 end:
-	if (data)
-		free(data);
-	if (signature)
-		free(signature);
+	if (data_buf)
+		free(data_buf);
+	if (sig_buf)
+		free(sig_buf);
 
 	return status;
 }
@@ -741,11 +1465,14 @@ int sblimg_update(void)
 
 	sbimghdr_t sbimg;
 
-	uint8_t *data = NULL;
-	uint8_t *signature = NULL;
+	const uint8_t *mapped = NULL;
+	const uint8_t *manifest_entry = NULL;
+	const uint8_t *data = NULL;
+	const uint8_t *signature = NULL;
+	uint8_t *data_buf = NULL;
+	uint8_t *sig_buf = NULL;
 
-	CHECK_OK(-EINTERNAL,
-	         sb_mem.read_img_func((void *)&sbimg, sb_mem.image_offset, HEADER_SIZE));
+	CHECK_OK(-EINTERNAL, read_header(&sbimg));
 
 	CHECK_OK(ESBIMGBOOT_IMAGE_BAD_HEADER_ID, sbimg.h_id != SBIMG_HEADER_MAGIC);
 
@@ -753,27 +1480,53 @@ int sblimg_update(void)
 	size_t cipher_size = COMPLETE_BLOCK_LENGTH(sbimg.pl_size);
 	size_t pl_size = (sbimg.flags_bits.encrypted) ? cipher_size : data_size;
 	size_t sign_size = (sbimg.flags_bits.signed_obj) ? RSA_MOD_LEN : 0;
+	size_t image_size = object_size(&sbimg);
 
-	size_t image_size = HEADER_SIZE + sign_size + data_size;
-	image_size = (sbimg.flags_bits.encrypted) ? COMPLETE_BLOCK_LENGTH(image_size) :
-	                                            ALIGN(image_size, 4);
+	const verified_obj_t *verified_obj = verified_next(&sbimg);
+
+	// Certificates verified by the check pass are kept, so they are just stepped over
+	if (verified_obj && (sbimg.flags_bits.obj_type == SBIMAGE_TYPE_ROOT_CERTIFICATE ||
+	                     sbimg.flags_bits.obj_type == SBIMAGE_TYPE_NON_ROOT_CERTIFICATE)) {
+		sb_mem.image_offset += image_size;
+		goto end;
+	}
 
 	if (sbimg.flags_bits.obj_type == SBIMAGE_TYPE_ROOT_CERTIFICATE ||
 	    sbimg.flags_bits.obj_type == SBIMAGE_TYPE_NON_ROOT_CERTIFICATE ||
-	    sbimg.flags_bits.obj_type == SBIMAGE_TYPE_ENCRYPTION_KEY) {
-		data = (uint8_t *)malloc(data_size);
-		CHECK_OK(-ENULL, data == NULL);
-		CHECK_OK(-EINTERNAL,
-		         sb_mem.read_img_func(data, sb_mem.image_offset + HEADER_SIZE + sign_size,
-		                              data_size));
+	    sbimg.flags_bits.obj_type == SBIMAGE_TYPE_ENCRYPTION_KEY ||
+	    sbimg.flags_bits.obj_type == SBIMAGE_TYPE_MANIFEST) {
+		// Signature and data are used right from the flash if it's memory-mapped
+		mapped = image_map(sb_mem.image_offset + HEADER_SIZE, sign_size + data_size);
+		if (!mapped)
+			mapped = image_window(sb_mem.image_offset + HEADER_SIZE,
+			                      sign_size + data_size);
+		if (mapped) {
+			signature = mapped;
+			data = mapped + sign_size;
+		} else {
+			data_buf = (uint8_t *)malloc(data_size);
+			CHECK_OK(-ENULL, data_buf == NULL);
+			CHECK_OK(-EINTERNAL,
+			         image_read(data_buf, sb_mem.image_offset + HEADER_SIZE + sign_size,
+			                    data_size));
+			data = data_buf;
+		}
+	}
+
+	if (sbimg.flags_bits.obj_type == SBIMAGE_TYPE_ROOT_CERTIFICATE ||
+	    sbimg.flags_bits.obj_type == SBIMAGE_TYPE_NON_ROOT_CERTIFICATE) {
+		data = cert_keep(data, data_size);
+		CHECK_OK(ESBIMGBOOT_MALLOC_ERR, data == NULL);
 	}
 
-	if (sbimg.flags_bits.obj_type == SBIMAGE_TYPE_ENCRYPTION_KEY && sign_size) {
-		signature = (uint8_t *)malloc(sign_size);
-		CHECK_OK(-ENULL, signature == NULL);
+	if (!mapped && sign_size &&
+	    (sbimg.flags_bits.obj_type == SBIMAGE_TYPE_ENCRYPTION_KEY ||
+	     sbimg.flags_bits.obj_type == SBIMAGE_TYPE_MANIFEST)) {
+		sig_buf = (uint8_t *)malloc(sign_size);
+		CHECK_OK(-ENULL, sig_buf == NULL);
 		CHECK_OK(-EINTERNAL,
-		         sb_mem.read_img_func(signature, sb_mem.image_offset + HEADER_SIZE,
-		                              sign_size));
+		         image_read(sig_buf, sb_mem.image_offset + HEADER_SIZE, sign_size));
+		signature = sig_buf;
 	}
 
 	CHECK_HEADER(&sbimg);
@@ -840,31 +1593,50 @@ int sblimg_update(void)
 
 		int num = 0;
 		SET_CERT_NUMBER(sbimg.sign_cert_id, num);
-		CHECK_OK(ESBIMGBOOT_ENC_KEY_BAD_SIGNATURE, verify(data, signature, data_size, num));
+		CHECK_OK(-EDATASIZE, data_size > AES_KEY_LEN);
 
-		sb_mem.cpy_func((void *)encrypted_key, (size_t)data, cipher_size);
+		// Key is verified in RAM, the flash may change after it's read
+		memset((void *)encrypted_key, 0, AES_KEY_LEN);
+		sb_mem.cpy_func((void *)encrypted_key, (uintptr_t)data, data_size);
+		CHECK_OK(ESBIMGBOOT_ENC_KEY_BAD_SIGNATURE,
+		         verify(encrypted_key, signature, data_size, num));
 		key_number = sbimg.aes_key_num;
 		break;
 
+	case SBIMAGE_TYPE_MANIFEST: {
+		int ret = manifest_handle(&sbimg, data, signature);
+		CHECK_OK(ret, ret != 0);
+		break;
+	}
+
 	case SBIMAGE_TYPE_PAYLOAD_NO_EXEC:
 	case SBIMAGE_TYPE_PAYLOAD_NO_RETURN:
 	case SBIMAGE_TYPE_PAYLOAD_WITH_RETURN:
 		CHECK_OK(ESBIMGBOOT_PAYLOAD_BAD_CERT_CHAIN,
 		         check_end_cert_load_requirement(&sbimg));
-		CHECK_OK(ESBIMGBOOT_PAYLOAD_IS_NOT_SIGNED, check_signed_load_requirement(&sbimg));
+		manifest_entry = manifest_next();
+		if (!manifest_entry)
+			CHECK_OK(ESBIMGBOOT_PAYLOAD_IS_NOT_SIGNED,
+			         check_signed_load_requirement(&sbimg));
 		CHECK_OK(ESBIMGBOOT_PAYLOAD_IS_NOT_ENCRYPTED,
 		         check_encrypted_load_requirement(&sbimg));
 
 		CHECK_OK(-EINVALIDDATA, sb_mem.chck_laddr_func(sbimg.l_addr, sbimg.pl_size));
 
-		int ret = image_handle(&sbimg, true);
+		size_t load_size = 0;
+		const uint8_t *verified_dgst = (verified_obj) ? verified_obj->payload_dgst : NULL;
+		int ret = image_handle(&sbimg, true, manifest_entry, verified_dgst, &load_size);
 		CHECK_OK(ret, ret != 0);
+		if (sbimg.flags_bits.obj_type == SBIMAGE_TYPE_PAYLOAD_NO_RETURN) {
+			memcpy((void *)&exec_header, (void *)&sbimg, sizeof(exec_header));
+			exec_size = load_size;
+		}
 		CHECK_OK(ESBIMGBOOT_LOAD_FINISH,
 		         sbimg.flags_bits.obj_type == SBIMAGE_TYPE_PAYLOAD_NO_RETURN);
 
 		if (sbimg.flags_bits.obj_type == SBIMAGE_TYPE_PAYLOAD_WITH_RETURN) {
 			CHECK_OK(-EINVALIDDATA,
-			         sb_mem.chck_eaddr_func(sbimg.l_addr, sbimg.pl_size, sbimg.e_addr));
+			         sb_mem.chck_eaddr_func(sbimg.l_addr, load_size, sbimg.e_addr));
 			EXECUTE(sbimg.e_addr);
 		}
 		break;
@@ -876,19 +1648,72 @@ int sblimg_update(void)
 	sb_mem.image_offset += image_size;
 
 end:
-	if (data)
-		free(data);
-	if (signature)
-		free(signature);
+	if (data_buf)
+		free(data_buf);
+	if (sig_buf)
+		free(sig_buf);
 
 	return status;
 }
 
+int sblimg_headers_digest(int count, uint8_t *digest)
+{
+	int status = ESBIMGBOOT_NO_ERR;
+	uintptr_t offset = sb_mem.image_offset;
+	SHA256_CTX sha256_ctx;
+	sbimghdr_t sbimg;
+
+	CHECK_NULL(digest);
+
+	SHA256_Init(&sha256_ctx);
+	for (int i = 0; i < count; i++) {
+		CHECK_OK(-EINTERNAL, sb_mem.read_img_func(&sbimg, offset, HEADER_SIZE));
+		CHECK_OK(ESBIMGBOOT_IMAGE_BAD_HEADER_ID, sbimg.h_id != SBIMG_HEADER_MAGIC);
+
+		SHA256_Update(&sha256_ctx, (const uint8_t *)&sbimg, HEADER_SIZE);
+		offset += object_size(&sbimg);
+	}
+	SHA256_Final(digest, &sha256_ctx);
+
+end:
+	return status;
+}
+
+int sblimg_rewind(sb_mem_t *sb_ctx)
+{
+	// Manifest objects are handled again, so payloads take their entries from the start
+	manifest_count = 0;
+	manifest_index = 0;
+	memset_s(manifest_dgst, 0, sizeof(manifest_dgst));
+
+	verified_index = 0;
+	verified_reuse = true;
+
+	return sblimg_init(sb_ctx);
+}
+
 void sblimg_abort(void)
 {
 	crypto_free();
 }
 
+int sblimg_entry(uintptr_t *e_addr)
+{
+	int status = ESBIMGBOOT_NO_ERR;
+
+	CHECK_NULL(e_addr);
+
+	// Verified header is used, the flash may be already released by the caller
+	CHECK_OK(-EINVALIDDATA, exec_header.h_id != SBIMG_HEADER_MAGIC);
+	CHECK_OK(-EINVALIDDATA,
+	         sb_mem.chck_eaddr_func(exec_header.l_addr, exec_size, exec_header.e_addr));
+
+	*e_addr = exec_header.e_addr;
+
+end:
+	return status;
+}
+
 void __dead2 sblimg_finish(int status)
 {
 	crypto_free();
@@ -896,13 +1721,11 @@ void __dead2 sblimg_finish(int status)
 	otp_clean_dump();
 
 	if (status == ESBIMGBOOT_LOAD_FINISH) {
-		sbimghdr_t sbimg;
+		uintptr_t e_addr = 0;
+		int ret = sblimg_entry(&e_addr);
 
-		CHECK_OK(-EINTERNAL,
-		         sb_mem.read_img_func((void *)&sbimg, sb_mem.image_offset, HEADER_SIZE));
-		CHECK_OK(-EINVALIDDATA,
-		         sb_mem.chck_eaddr_func(sbimg.l_addr, sbimg.pl_size, sbimg.e_addr));
-		EXECUTE(sbimg.e_addr);
+		CHECK_OK(ret, ret != ESBIMGBOOT_NO_ERR);
+		EXECUTE(e_addr);
 	}
 
 end:
@@ -23,18 +23,67 @@
 #define ALIGN(var, len)            ((var) + (((len) - ((var) % (len))) % (len)))
 #define COMPLETE_BLOCK_LENGTH(var) ALIGN((var), AES_BLOCK_LEN)
 
+// Payload is read, hashed and deciphered by chunks of this size (multiple of AES_BLOCK_LEN)
+#ifndef SBIMG_CHUNK_SIZE
+#define SBIMG_CHUNK_SIZE 0x4000
+#endif
+
+// Chunk is processed by slices of this size, the background reading is kept busy between them
+#ifndef SBIMG_POLL_SLICE
+#define SBIMG_POLL_SLICE 0x200
+#endif
+
+/**
+ * Headers, signatures and data of small objects are read through the window of this size, one
+ * flash read gets the header, signature and data of a certificate or a key together with
+ * the header of the next object
+ */
+#ifndef SBIMG_READAHEAD_SIZE
+#define SBIMG_READAHEAD_SIZE 0x800
+#endif
+
+// Encrypted slice is hashed and deciphered by blocks of this size copied to the stack
+#ifndef SBIMG_FUSED_BLOCK
+#define SBIMG_FUSED_BLOCK 64
+#endif
+
 #define SBIMAGE_TYPE_PAYLOAD_NO_RETURN    0
 #define SBIMAGE_TYPE_ENCRYPTION_KEY       1
 #define SBIMAGE_TYPE_ROOT_CERTIFICATE     2
 #define SBIMAGE_TYPE_NON_ROOT_CERTIFICATE 3
 #define SBIMAGE_TYPE_PAYLOAD_WITH_RETURN  4
 #define SBIMAGE_TYPE_PAYLOAD_NO_EXEC      5
+/**
+ * Signed list of SHA-256 digests of the following payloads, one per payload in image order.
+ * Digest is calculated the same way as for payload signature: over the ciphertext if
+ * sign_of_encrypted flag is set and over the plain data otherwise. Payloads covered by
+ * the manifest are accepted without their own signature.
+ */
+#define SBIMAGE_TYPE_MANIFEST 6
+
+// Maximum number of payload digests in the manifest
+#ifndef SBIMG_MANIFEST_MAX_ENTRIES
+#define SBIMG_MANIFEST_MAX_ENTRIES 16
+#endif
+
+// Maximum number of certificates and payloads verified by the check pass to be reused
+#ifndef SBIMG_VERIFIED_MAX_OBJECTS
+#define SBIMG_VERIFIED_MAX_OBJECTS 16
+#endif
+
+// Size of the store keeping DER of the parsed certificates, X.509 contexts point into it
+#ifndef SBIMG_CERT_STORE_SIZE
+#define SBIMG_CERT_STORE_SIZE 0x2000
+#endif
 
 typedef void *(*memcopy_t)(void *, uintptr_t, size_t);
 typedef int (*chck_laddr_t)(uintptr_t, uint32_t);
 typedef int (*chck_eaddr_t)(uintptr_t, uint32_t, uintptr_t);
 typedef int (*chck_img_t)(const void *, size_t);
 typedef int (*read_img_t)(void *, signed long, size_t);
+typedef int (*read_img_start_t)(void *, signed long, size_t);
+typedef int (*read_img_poll_t)(void);
+typedef const void *(*map_img_t)(signed long, size_t);
 
 typedef struct {
 	chck_laddr_t chck_laddr_func;
@@ -42,12 +91,69 @@ typedef struct {
 	chck_img_t chck_img;
 	memcopy_t cpy_func;
 	read_img_t read_img_func;
+	/**
+	 * Optional background reading: read_start_func starts reading of the next payload chunk
+	 * and read_poll_func moves it forward, returning number of bytes left (0 when done) or
+	 * negative error code. Payload is read by read_img_func synchronously if they are NULL.
+	 */
+	read_img_start_t read_start_func;
+	read_img_poll_t read_poll_func;
+	/**
+	 * Optional memory-mapped access: map_img_func returns a pointer to the image data or NULL
+	 * if it can't be mapped. The pointer is valid until the next read_img_func/read_start_func
+	 * call. Headers and signatures are used in place if it's provided, certificates, keys and
+	 * manifests are copied to RAM before they are verified. Plain payload is hashed in place on
+	 * the check pass.
+	 */
+	map_img_t map_img_func;
 	uintptr_t image_offset;
 	otp_t *otp;
 } sb_mem_t;
 
 int sblimg_init(sb_mem_t *sb_ctx);
 int sblimg_update(void);
+
+/**
+ * @brief Get entry address of the payload without return loaded by the update pass. It's
+ *        checked by chck_eaddr_func against the loaded data, the decompressed one for
+ *        compressed payload. sblimg_finish() starts the payload from this address.
+ *
+ * @param e_addr - Entry address
+ *
+ * @return ESBIMGBOOT_NO_ERR - Success,
+ *         -ENULL            - e_addr is NULL,
+ *         -EINVALIDDATA     - No payload without return is loaded or its entry is rejected
+ */
+int sblimg_entry(uintptr_t *e_addr);
 void __dead2 sblimg_finish(int status);
 void sblimg_abort(void);
 int sblimg_check(void);
+
+/**
+ * @brief Start the update pass over the image checked by sblimg_check() instead of
+ *        sblimg_abort() and sblimg_init(). Certificates verified by the check pass are kept
+ *        and stepped over, verified payloads are loaded with their digests compared to
+ *        the check pass ones instead of signature verification. The objects are matched
+ *        by offset and header, changed ones are verified as usual.
+ *
+ * @param sb_ctx - Memory context of the update pass
+ *
+ * @return ESBIMGBOOT_NO_ERR - Success,
+ *         -ENULL            - OTP dump isn't available
+ */
+int sblimg_rewind(sb_mem_t *sb_ctx);
+
+/**
+ * @brief Calculate SHA-256 over headers of the first objects of the image, the image isn't
+ *        verified. Headers contain payload digests, so the result identifies contents of
+ *        the objects.
+ *
+ * @param count  - Number of objects starting from image_offset passed to sblimg_init()
+ * @param digest - Output buffer of SHA256_SIZE bytes
+ *
+ * @return ESBIMGBOOT_NO_ERR              - Success,
+ *         ESBIMGBOOT_IMAGE_BAD_HEADER_ID - Image contains less than count objects,
+ *         -ENULL                         - digest is NULL,
+ *         -EINTERNAL                     - Read error
+ */
+int sblimg_headers_digest(int count, uint8_t *digest);
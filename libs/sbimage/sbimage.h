@@ -28,8 +28,14 @@ typedef struct {
 	unsigned int signed_obj : 1;
 	// 1: In bs_en=0 mode skip header checksum verification
 	unsigned int skip_header_hash : 1;
+	/**
+	 * 0: Payload is not compressed.
+	 * 1: Payload is LZ4 frame with content size, it's decompressed to the load address.
+	 *    Payload size, digest and signature are of the compressed data.
+	 */
+	unsigned int compressed : 1;
 	// Reserved
-	unsigned int reserved : 24;
+	unsigned int reserved : 23;
 } flags_t;
 
 typedef struct {
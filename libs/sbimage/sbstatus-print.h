@@ -187,6 +187,30 @@ static inline int sblimg_print_status(int status)
 		ERROR("%s\n", "Memory allocation error");
 		break;
 
+	case ESBIMGBOOT_MANIFEST_IS_NOT_SIGNED:
+		ERROR("%s\n", "Manifest: isn't signed");
+		break;
+
+	case ESBIMGBOOT_MANIFEST_BAD_SIZE:
+		ERROR("%s\n", "Manifest: incorrect size");
+		break;
+
+	case ESBIMGBOOT_MANIFEST_BAD_SIGNATURE:
+		ERROR("%s\n", "Manifest: incorrect signature");
+		break;
+
+	case ESBIMGBOOT_PAYLOAD_BAD_MANIFEST_HASH:
+		ERROR("%s\n", "Payload: hash doesn't match manifest");
+		break;
+
+	case ESBIMGBOOT_PAYLOAD_BAD_COMPRESSION:
+		ERROR("%s\n", "Payload: incorrect LZ4 frame or size");
+		break;
+
+	case ESBIMGBOOT_ENC_KEY_UNAVAILABLE:
+		ERROR("%s\n", "Encryption key: DUK is cleared, payload can't be deciphered");
+		break;
+
 	default:
 		ERROR("%s\n", "Unknown status");
 		break;
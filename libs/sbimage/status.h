@@ -33,5 +33,11 @@ enum sbl_s2_status_codes {
 	ESBIMGBOOT_PAYLOAD_BAD_HASH,
 	ESBIMGBOOT_PAYLOAD_BAD_SIGNATURE,
 	ESBIMGBOOT_PAYLOAD_BAD_FW_COUNTER,
-	ESBIMGBOOT_MALLOC_ERR
+	ESBIMGBOOT_MALLOC_ERR,
+	ESBIMGBOOT_MANIFEST_IS_NOT_SIGNED,
+	ESBIMGBOOT_MANIFEST_BAD_SIZE,
+	ESBIMGBOOT_MANIFEST_BAD_SIGNATURE,
+	ESBIMGBOOT_PAYLOAD_BAD_MANIFEST_HASH,
+	ESBIMGBOOT_PAYLOAD_BAD_COMPRESSION,
+	ESBIMGBOOT_ENC_KEY_UNAVAILABLE
 };
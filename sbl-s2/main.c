@@ -8,6 +8,7 @@
 #include <string.h>
 
 #include <drivers/factory-reset/factory-reset.h>
+#include <drivers/ls-periph0/ls-periph0.h>
 #include <drivers/ls-periph1/ls-periph1.h>
 #include <drivers/spi-nor/spi-nor.h>
 #include <drivers/timer/timer.h>
@@ -22,6 +23,7 @@
 #include <libs/sbimage/sbstatus-print.h>
 #include <libs/sbimage/status.h>
 #include <libs/utils-def.h>
+#include <third-party/crypto/crypto.h>
 #include <third-party/libfdt/libfdt.h>
 
 #include "platform-def.h"
@@ -89,7 +91,23 @@ static const uintptr_t ram_start = (uintptr_t)&__ram_start;
 static const uintptr_t ram_end = (uintptr_t)&__ram_end;
 
 #ifdef RECOVERY_ENABLE
+#define RECOVERY_PIN_ENV "recovery_pin"
+
+// Factory reset pin description cached in SBL environment as hex string
+typedef struct {
+	uint32_t gpio_regs;
+	uint32_t port;
+	uint32_t pin;
+	uint32_t active_low;
+	// Number of recovery image objects up to the DTB and digest of their headers
+	uint32_t objects;
+	uint8_t digest[SHA256_SIZE];
+} recovery_pin_cache_t;
+
 static volatile uint64_t last = 0;
+static factory_reset_info_t recovery_pin;
+static int recovery_pin_objects = 0;
+static int recovery_objects = 0;
 #endif
 
 static volatile int recovery_mode = 0;
@@ -127,6 +145,28 @@ static int read_image(void *dst, signed long offset, size_t size)
 	return spi_nor_read(dst, (uint32_t)offset, size);
 }
 
+static int read_image_start(void *dst, signed long offset, size_t size)
+{
+	uint32_t flash_size = spi_nor_get_size();
+
+	if (offset < 0)
+		offset = (signed long)flash_size + offset;
+
+	return spi_nor_read_start(dst, (uint32_t)offset, size);
+}
+
+#ifdef SPI_NOR_XIP_MAP_ENABLE
+static const void *map_image(signed long offset, size_t size)
+{
+	uint32_t flash_size = spi_nor_get_size();
+
+	if (offset < 0)
+		offset = (signed long)flash_size + offset;
+
+	return spi_nor_xip_map((uint32_t)offset, size);
+}
+#endif
+
 #ifdef RECOVERY_ENABLE
 static int check_recovery_image(const void *data, size_t data_size)
 {
@@ -134,6 +174,11 @@ static int check_recovery_image(const void *data, size_t data_size)
 
 	int ret = factory_reset_get_info(data, &factory_reset_info);
 	if (!ret) {
+		if (!recovery_pin_objects) {
+			recovery_pin = factory_reset_info;
+			recovery_pin_objects = recovery_objects + 1;
+		}
+
 		ret = factory_reset_init(&factory_reset_info);
 		if (!ret) {
 			uint64_t target = PLAT_RECOVERY_TIMEOUT_SEC * USEC_IN_SEC + last;
@@ -172,6 +217,106 @@ static int prepare_recovery(void)
 
 	return 0;
 }
+
+static int hex_digit(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+
+	return -1;
+}
+
+static int recovery_pin_cache_get(env_ctx_t *sbl, recovery_pin_cache_t *cache)
+{
+	const char *str = env_get(sbl, RECOVERY_PIN_ENV);
+	uint8_t *bytes = (uint8_t *)cache;
+
+	if (!str || strlen(str) != sizeof(*cache) * 2)
+		return -EINVALIDDATA;
+
+	for (size_t i = 0; i < sizeof(*cache); i++) {
+		int hi = hex_digit(str[i * 2]);
+		int lo = hex_digit(str[i * 2 + 1]);
+
+		if (hi < 0 || lo < 0)
+			return -EINVALIDDATA;
+
+		bytes[i] = (uint8_t)((hi << 4) | lo);
+	}
+
+	// The pin is sampled before any verification, so only existing GPIO pins are accepted
+	if (cache->gpio_regs != BASE_ADDR_LSP0_GPIO0_BASE &&
+	    cache->gpio_regs != BASE_ADDR_LSP1_GPIO1_BASE)
+		return -EINVALIDDATA;
+
+	if (cache->port > GPIO_PORTD || cache->pin >= 32 || cache->active_low > 1)
+		return -EINVALIDDATA;
+
+	return 0;
+}
+
+/**
+ * The whole recovery image is verified only to find the factory reset pin in its DTB.
+ * The pin found by the previous full check is cached in SBL environment along with
+ * the digest of object headers up to the DTB (headers contain payload digests). The check
+ * is skipped if the headers are the same and the button isn't pressed. The environment isn't
+ * authenticated, so GPIO block, port, pin and active level of the cache are checked before
+ * the pin is sampled. The cache is only a hint: recovery mode is entered by the full check
+ * with the pin from the verified DTB.
+ */
+static bool recovery_check_skip(env_ctx_t *sbl, sb_mem_t *sbmem)
+{
+	recovery_pin_cache_t cache;
+	uint8_t digest[SHA256_SIZE];
+
+	if (recovery_pin_cache_get(sbl, &cache))
+		return false;
+
+	if (sblimg_init(sbmem) != ESBIMGBOOT_NO_ERR ||
+	    sblimg_headers_digest(cache.objects, digest) != ESBIMGBOOT_NO_ERR ||
+	    memcmp(digest, cache.digest, sizeof(digest)))
+		return false;
+
+	factory_reset_info_t info = { .gpio_regs = (gpio_regs_t *)(uintptr_t)cache.gpio_regs,
+		                      .port = cache.port,
+		                      .pin = cache.pin,
+		                      .active_low = cache.active_low };
+
+	if (factory_reset_init(&info))
+		return false;
+
+	return !factory_reset_is_pressed(&info);
+}
+
+static void recovery_pin_cache_update(env_ctx_t *sbl, sb_mem_t *sbmem)
+{
+	recovery_pin_cache_t cache = { .gpio_regs = (uintptr_t)recovery_pin.gpio_regs,
+		                       .port = recovery_pin.port,
+		                       .pin = recovery_pin.pin,
+		                       .active_low = recovery_pin.active_low,
+		                       .objects = recovery_pin_objects };
+	const uint8_t *bytes = (const uint8_t *)&cache;
+	char str[sizeof(cache) * 2 + 1];
+
+	if (!recovery_pin_objects)
+		return;
+
+	if (sblimg_init(sbmem) != ESBIMGBOOT_NO_ERR ||
+	    sblimg_headers_digest(recovery_pin_objects, cache.digest) != ESBIMGBOOT_NO_ERR)
+		return;
+
+	for (size_t i = 0; i < sizeof(cache); i++)
+		snprintf(&str[i * 2], 3, "%02x", bytes[i]);
+
+	char *old = env_get(sbl, RECOVERY_PIN_ENV);
+	if (old && !strcmp(old, str))
+		return;
+
+	env_set(sbl, RECOVERY_PIN_ENV, str);
+	env_export(sbl);
+}
 #endif
 
 static int prepare_env(env_ctx_t *sbl)
@@ -367,46 +512,73 @@ int main(void)
 	if (ret)
 		panic_handler("SPI NOR init failed, ret=%d\n", ret);
 
+#ifdef SPI_NOR_BENCHMARK_ENABLE
+	ret = spi_nor_benchmark();
+	if (ret)
+		WARN("SPI NOR benchmark failed, ret=%d\n", ret);
+#endif
+
 #if defined(BOOTSTAGE_ENABLE)
 	bootstage_mark(BOOTSTAGE_ID_SBL_S2_LOAD_START);
 #endif
 
-#ifdef RECOVERY_ENABLE
-	NOTICE("Please wait. FW is checking...\n");
+	prepare_env(&sbl);
 
+#ifdef RECOVERY_ENABLE
 	memset((void *)&sbmem, 0, sizeof(sbmem));
 	sbmem.chck_laddr_func = NULL;
 	sbmem.chck_eaddr_func = NULL;
 	sbmem.chck_img = (chck_img_t)check_recovery_image;
 	sbmem.cpy_func = (memcopy_t)memcpy;
 	sbmem.read_img_func = (read_img_t)read_image;
+	sbmem.read_start_func = (read_img_start_t)read_image_start;
+	sbmem.read_poll_func = (read_img_poll_t)spi_nor_read_poll;
+#ifdef SPI_NOR_XIP_MAP_ENABLE
+	sbmem.map_img_func = (map_img_t)map_image;
+#endif
 	sbmem.image_offset = (uintptr_t)PLAT_OFFSET_FIRMWARE_R;
 
-	ret = sblimg_init(&sbmem);
-	while (ret == ESBIMGBOOT_NO_ERR) {
-		ret = sblimg_check();
+	if (recovery_check_skip(&sbl, &sbmem)) {
+		INFO("Recovery FW check is skipped, factory reset button is released\n");
+	} else {
+		NOTICE("Please wait. FW is checking...\n");
+
+		ret = sblimg_init(&sbmem);
+		while (ret == ESBIMGBOOT_NO_ERR) {
+			ret = sblimg_check();
+			recovery_objects++;
 #ifdef WDT_ENABLE
-		wdt_reset(wdt);
+			wdt_reset(wdt);
 #endif
-	}
+		}
 
-	sblimg_abort();
+		// Results of the check pass are reused by the update pass of the recovery image
+		if (recovery_mode == 0)
+			sblimg_abort();
 
-	if (ret != ESBIMGBOOT_IMAGE_BAD_HEADER_ID && ret != ESBIMGBOOT_IMAGE_BAD_HEADER_HASH)
-		sblimg_print_return_code(ret);
+		if (ret != ESBIMGBOOT_IMAGE_BAD_HEADER_ID &&
+		    ret != ESBIMGBOOT_IMAGE_BAD_HEADER_HASH)
+			sblimg_print_return_code(ret);
+
+		if (recovery_mode == 0)
+			recovery_pin_cache_update(&sbl, &sbmem);
+	}
 #endif
 
 	ret = secure_setup();
 	if (ret)
 		panic_handler("Failed to setup secure regions, ret=%d\n", ret);
 
-	prepare_env(&sbl);
-
 	memset((void *)&sbmem, 0, sizeof(sbmem));
 	sbmem.chck_laddr_func = (chck_laddr_t)check_load_address;
 	sbmem.chck_eaddr_func = (chck_eaddr_t)check_exec_address;
 	sbmem.cpy_func = (memcopy_t)memcpy;
 	sbmem.read_img_func = (read_img_t)read_image;
+	sbmem.read_start_func = (read_img_start_t)read_image_start;
+	sbmem.read_poll_func = (read_img_poll_t)spi_nor_read_poll;
+#ifdef SPI_NOR_XIP_MAP_ENABLE
+	sbmem.map_img_func = (map_img_t)map_image;
+#endif
 	sbmem.chck_img = NULL;
 
 	if (recovery_mode == 0) {
@@ -427,7 +599,12 @@ int main(void)
 #endif
 	}
 
-	ret = sblimg_init(&sbmem);
+#ifdef RECOVERY_ENABLE
+	if (recovery_mode)
+		ret = sblimg_rewind(&sbmem);
+	else
+#endif
+		ret = sblimg_init(&sbmem);
 	while (ret == ESBIMGBOOT_NO_ERR) {
 		ret = sblimg_update();
 #ifdef WDT_ENABLE
@@ -435,6 +612,11 @@ int main(void)
 #endif
 	}
 
+	// Flash isn't used by SBL-S2 anymore, it's returned to 3-byte address mode
+	int deinit_ret = spi_nor_deinit();
+	if (deinit_ret)
+		WARN("SPI NOR deinit failed, ret=%d\n", deinit_ret);
+
 #if defined(BOOTSTAGE_ENABLE)
 	bootstage_mark(BOOTSTAGE_ID_SBL_S2_LOAD_COMPLETE);
 	bootstage_export((void *)bs_start, bs_end - bs_start);
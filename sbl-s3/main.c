@@ -47,6 +47,9 @@ int main(int argc, char **argv)
 
 	bootstage_import((void *)bs_start, bs_end - bs_start);
 	bootstage_mark(BOOTSTAGE_ID_SBL_S3_START);
+
+	// Records of SBL-S2 image loading aren't changed by the SBIMG executor used by services
+	bootstage_freeze();
 #endif
 
 #ifdef UART_ENABLE
@@ -123,6 +126,7 @@ int main(int argc, char **argv)
 
 	for (;;) {
 		risc0_ipc_handler();
+		risc0_ipc_background_handler();
 
 #if defined(WDT_ENABLE) && defined(WDT_RESET_INTERNAL)
 		wdt_reset(wdt);
@@ -1,89 +1,122 @@
 // SPDX-License-Identifier: MIT
 // Copyright 2023-2025 RnD Center "ELVEES", JSC
 
-#include <malloc.h>
+#include <stdbool.h>
 #include <string.h>
 #include <sys/cdefs.h>
 
 #include <drivers/iommu/iommu.h>
 #include <drivers/irq/irq.h>
 #include <drivers/mailbox/mailbox.h>
-#include <drivers/mips-cp0/mips-cp0.h>
 #include <libs/helpers/helpers.h>
 #include <libs/log.h>
-#include <libs/queue/queue.h>
 #include <libs/utils-def.h>
 
 #include "api.h"
 #include "ipc.h"
 #include "protocol.h"
 
-#define CRITICAL_SECTION_ENTER mips_global_irq_disable
-#define CRITICAL_SECTION_EXIT  mips_global_irq_enable
+// Number of requests of one link waiting for the main loop, must be a power of two
+#define RISC0_IPC_RING_SIZE 4
 
 typedef struct {
 	uint32_t link_id;
 	risc0_ipc_req_t req;
 } risc0_ipc_msg_t;
 
-static queue_t mbox_msgs = { 0 };
+/**
+ * Requests received from one mailbox link. Head is advanced by the IRQ handler only and tail
+ * by the main loop only, so the ring is shared without a critical section. Requests which
+ * don't fit are dropped, their response memory is kept in the drops ring the same way,
+ * so the main loop replies RISC0_IPC_RESP_STATE_DROPPED to them.
+ */
+typedef struct {
+	risc0_ipc_req_t reqs[RISC0_IPC_RING_SIZE];
+	volatile uint32_t head;
+	volatile uint32_t tail;
+	risc0_ipc_shrmem_t drops[RISC0_IPC_RING_SIZE];
+	volatile uint32_t drop_head;
+	volatile uint32_t drop_tail;
+} risc0_ipc_ring_t;
+
+static risc0_ipc_ring_t mbox_rings[MAILBOX_FIFO_COUNT] = { 0 };
 
 static void risc0_ipc_irq_handler(unsigned int fifo_num)
 {
 	mailbox_regs_t *regs = mbox_get_regs();
+	risc0_ipc_ring_t *ring = &mbox_rings[fifo_num];
+	risc0_ipc_req_t dropped;
+	risc0_ipc_req_t *req = &dropped;
 
 	int empty = mbox_is_empty(&regs->mailbox[fifo_num]);
 	if (empty)
 		return;
 
-	risc0_ipc_msg_t *msg = malloc(sizeof(risc0_ipc_msg_t));
-	if (!msg)
-		panic_handler("No free memory\n");
+	// Request is read out of the mailbox anyway, otherwise the link is stuck
+	bool full = (ring->head - ring->tail) == RISC0_IPC_RING_SIZE;
+	if (!full)
+		req = &ring->reqs[ring->head % RISC0_IPC_RING_SIZE];
 
 	unsigned int count =
-		mbox_read(&regs->mailbox[fifo_num], (char *)&msg->req.hdr, sizeof(msg->req.hdr));
-	if (count != sizeof(msg->req.hdr) || msg->req.hdr.magic_num != RISC0_IPC_MAGIC)
+		mbox_read(&regs->mailbox[fifo_num], (char *)&req->hdr, sizeof(req->hdr));
+	if (count != sizeof(req->hdr) || req->hdr.magic_num != RISC0_IPC_MAGIC)
 		return;
 
-	if (msg->req.hdr.cmd_len != sizeof(msg->req.cmd))
+	if (req->hdr.cmd_len != sizeof(req->cmd))
 		panic_handler("Wrong cmd len=%d\n", count);
 
-	count = mbox_read(&regs->mailbox[fifo_num], (char *)&msg->req.cmd, sizeof(msg->req.cmd));
-	if (count != sizeof(msg->req.cmd))
+	count = mbox_read(&regs->mailbox[fifo_num], (char *)&req->cmd, sizeof(req->cmd));
+	if (count != sizeof(req->cmd))
 		panic_handler("Wrong cmd len=%d\n", count);
 
-	if (msg->req.hdr.shrmem_len) {
-		if (msg->req.hdr.shrmem_len != sizeof(msg->req.shrmem))
+	if (req->hdr.shrmem_len) {
+		if (req->hdr.shrmem_len != sizeof(req->shrmem))
 			panic_handler("Wrong resp len=%d\n", count);
 
-		count = mbox_read(&regs->mailbox[fifo_num], (char *)&msg->req.shrmem,
-		                  sizeof(msg->req.shrmem));
-		if (count != sizeof(msg->req.shrmem))
+		count = mbox_read(&regs->mailbox[fifo_num], (char *)&req->shrmem,
+		                  sizeof(req->shrmem));
+		if (count != sizeof(req->shrmem))
 			panic_handler("Wrong resp len=%d\n", count);
 	}
 
-	msg->link_id = fifo_num;
+	if (full) {
+		ERROR("Link %u has too many requests, service=%d is dropped\n", fifo_num,
+		      req->cmd.hdr.service);
+
+		// Sender isn't replied if the drops ring is full too, it waits for its timeout
+		if (!req->hdr.shrmem_len ||
+		    (ring->drop_head - ring->drop_tail) == RISC0_IPC_RING_SIZE)
+			return;
+
+		ring->drops[ring->drop_head % RISC0_IPC_RING_SIZE] = req->shrmem;
+		wmem_barrier();
+		ring->drop_head++;
+		return;
+	}
 
-	queue_push(&mbox_msgs, msg);
+	// Request must be visible to the main loop before the slot is published
+	wmem_barrier();
+	ring->head++;
 }
 
-static void risc0_ipc_resp(risc0_ipc_req_t *req, risc0_ipc_resp_param_t *resp_param)
+static void risc0_ipc_resp(const risc0_ipc_shrmem_t *shrmem, risc0_ipc_resp_param_t *resp_param,
+                           risc0_ipc_resp_state state)
 {
 	risc0_ipc_resp_t *resp = NULL;
 	iommu_regs_t *iommu_regs = iommu_get_registers();
 
 	// Protect firmware from writing in it's own address space (first 4 GB)
-	if (req->shrmem.data <= UINTPTR_MAX)
+	if (shrmem->data <= UINTPTR_MAX)
 		panic_handler("The address[0x%llu] must be outside 32bit address space\n",
-		              req->shrmem.data);
+		              shrmem->data);
 
-	resp = (risc0_ipc_resp_t *)iommu_map(iommu_regs, req->shrmem.data);
+	resp = (risc0_ipc_resp_t *)iommu_map(iommu_regs, shrmem->data);
 	if (!resp)
 		panic_handler("No free memory\n");
 	memcpy((void *)&resp->param, (void *)resp_param, sizeof(risc0_ipc_resp_param_t));
 	wmem_barrier();
 
-	resp->state.value = RISC0_IPC_RESP_STATE_COMPLETE;
+	resp->state.value = state;
 	wmem_barrier();
 
 	iommu_unmap(iommu_regs, (uintptr_t)resp);
@@ -93,6 +126,9 @@ static void risc0_ipc_cmd_handler(risc0_ipc_msg_t *msg)
 {
 	risc0_ipc_resp_param_t resp_param;
 
+	// Rejected and unsupported requests are completed with zeroed parameters
+	memset((void *)&resp_param, 0, sizeof(resp_param));
+
 	switch (msg->req.cmd.hdr.service) {
 	case RISC0_IPC_INIT:
 		risc0_ipc_init_handler(msg->link_id, &msg->req.cmd, &resp_param);
@@ -112,13 +148,23 @@ static void risc0_ipc_cmd_handler(risc0_ipc_msg_t *msg)
 	case RISC0_IPC_OTP:
 		risc0_ipc_otp_handler(msg->link_id, &msg->req.cmd, &resp_param);
 		break;
+#if defined(SLOT_SCAN_ENABLE)
+	case RISC0_IPC_SLOT_SCAN:
+		risc0_ipc_slot_scan_handler(msg->link_id, &msg->req.cmd, &resp_param);
+		break;
+#endif
+#if defined(UPDATE_ENABLE)
+	case RISC0_IPC_UPDATE:
+		risc0_ipc_update_handler(msg->link_id, &msg->req.cmd, &resp_param);
+		break;
+#endif
 	default:
 		ERROR("Unsupported mbox service=%d\n", msg->req.cmd.hdr.service);
 		break;
 	}
 
 	if (msg->req.hdr.shrmem_len)
-		risc0_ipc_resp(&msg->req, &resp_param);
+		risc0_ipc_resp(&msg->req.shrmem, &resp_param, RISC0_IPC_RESP_STATE_COMPLETE);
 }
 
 uint32_t risc0_ipc_start(void)
@@ -126,6 +172,7 @@ uint32_t risc0_ipc_start(void)
 	COMPILE_TIME_ASSERT(!(sizeof(risc0_ipc_hdr_t) % sizeof(uint32_t)));
 	COMPILE_TIME_ASSERT(!(sizeof(risc0_ipc_cmd_t) % sizeof(uint32_t)));
 	COMPILE_TIME_ASSERT(!(sizeof(risc0_ipc_shrmem_t) % sizeof(uint32_t)));
+	COMPILE_TIME_ASSERT(!(RISC0_IPC_RING_SIZE & (RISC0_IPC_RING_SIZE - 1)));
 
 	int ret = risc0_ipc_otp_init();
 	if (ret)
@@ -148,14 +195,63 @@ uint32_t risc0_ipc_stop(void)
 
 void risc0_ipc_handler(void)
 {
-	// Ensure that all instructions are completed before enter to critical section
-	mem_barrier();
+	// Links are polled round-robin, so a busy link doesn't delay the others
+	static uint32_t next_link = 0;
+	risc0_ipc_ring_t *ring = NULL;
+	risc0_ipc_msg_t msg;
+	uint32_t link_id;
+
+	for (uint32_t i = 0; i < MAILBOX_FIFO_COUNT; i++) {
+		link_id = (next_link + i) % MAILBOX_FIFO_COUNT;
+		if (mbox_rings[link_id].head != mbox_rings[link_id].tail ||
+		    mbox_rings[link_id].drop_head != mbox_rings[link_id].drop_tail) {
+			ring = &mbox_rings[link_id];
+			break;
+		}
+	}
+
+	if (!ring)
+		return;
+
+	next_link = (link_id + 1) % MAILBOX_FIFO_COUNT;
 
-	CRITICAL_SECTION_ENTER();
-	void *data = queue_pop(&mbox_msgs);
-	if (data) {
-		risc0_ipc_cmd_handler((risc0_ipc_msg_t *)data);
-		free(data);
+	// Dropped requests are replied first, so their senders don't wait for the queued ones
+	if (ring->drop_head != ring->drop_tail) {
+		risc0_ipc_resp_param_t resp_param;
+		risc0_ipc_shrmem_t shrmem;
+
+		rmem_barrier();
+		shrmem = ring->drops[ring->drop_tail % RISC0_IPC_RING_SIZE];
+		mem_barrier();
+		ring->drop_tail++;
+
+		memset((void *)&resp_param, 0, sizeof(resp_param));
+		risc0_ipc_resp(&shrmem, &resp_param, RISC0_IPC_RESP_STATE_DROPPED);
+		return;
 	}
-	CRITICAL_SECTION_EXIT();
+
+	// Request is read only after the IRQ handler has published it
+	rmem_barrier();
+	msg.link_id = link_id;
+	memcpy((void *)&msg.req, (void *)&ring->reqs[ring->tail % RISC0_IPC_RING_SIZE],
+	       sizeof(msg.req));
+
+	/**
+	 * Slot is released before the request is handled, as requests are handled from
+	 * the background services by nested calls.
+	 */
+	mem_barrier();
+	ring->tail++;
+
+	risc0_ipc_cmd_handler(&msg);
+}
+
+void risc0_ipc_background_handler(void)
+{
+#if defined(SLOT_SCAN_ENABLE)
+	risc0_ipc_slot_scan_step();
+#endif
+#if defined(UPDATE_ENABLE)
+	risc0_ipc_update_step();
+#endif
 }
@@ -8,3 +8,6 @@
 uint32_t risc0_ipc_start(void);
 uint32_t risc0_ipc_stop(void);
 void risc0_ipc_handler(void);
+
+// Run background work of the services, it's called by the main loop after risc0_ipc_handler()
+void risc0_ipc_background_handler(void);
@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: MIT
+// Copyright 2025 RnD Center "ELVEES", JSC
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <drivers/spi-nor/spi-nor.h>
+#include <libs/env/env-io.h>
+#include <libs/env/env.h>
+#include <libs/errors.h>
+#include <libs/log.h>
+#include <libs/platform-def-common.h>
+
+#include "fw-slot.h"
+
+static const char *const slot_names[] = { "a", "b" };
+
+static bool flash_busy = false;
+
+int fw_slot_flash_acquire(void)
+{
+	int ret;
+
+	if (flash_busy)
+		return -EALREADYINITIALIZED;
+
+	ret = spi_nor_init();
+	if (ret)
+		return ret;
+
+	flash_busy = true;
+
+	return 0;
+}
+
+void fw_slot_flash_release(void)
+{
+	// Flash is returned to the state expected by the non-secure world
+	int ret = spi_nor_deinit();
+	if (ret)
+		WARN("SPI NOR deinit failed, ret=%d\n", ret);
+
+	flash_busy = false;
+}
+
+int fw_slot_inactive(int *slot, bool *trial)
+{
+	env_ctx_t sbl;
+	int ret;
+
+	if (!slot || !trial)
+		return -ENULL;
+
+	*slot = 1;
+	*trial = false;
+
+	ret = env_init(&sbl, PLAT_SBL_ENV_OFF, PLAT_ENV_SIZE, ENV_IO_SPI);
+	if (ret)
+		return ret;
+
+	// Environment is missing until SBL-S2 creates it, then slot A is booted
+	if (!env_import(&sbl)) {
+		char *bootvol = env_get(&sbl, "bootvol");
+		char *safe_bootvol = env_get(&sbl, "safe_bootvol");
+
+		if (bootvol && !strcmp(bootvol, slot_names[1]))
+			*slot = 0;
+		if (bootvol && safe_bootvol && strcmp(bootvol, safe_bootvol))
+			*trial = true;
+	}
+
+	env_deinit(&sbl);
+
+	return 0;
+}
+
+int fw_slot_commit(int slot)
+{
+	env_ctx_t sbl;
+	int ret;
+
+	if (slot < 0 || slot > 1)
+		return -EINVALIDPARAM;
+
+	ret = env_init(&sbl, PLAT_SBL_ENV_OFF, PLAT_ENV_SIZE, ENV_IO_SPI);
+	if (ret)
+		return ret;
+
+	// Missing environment is created, the other slot stays the safe one
+	env_import(&sbl);
+	if (!env_get(&sbl, "safe_bootvol")) {
+		ret = env_set(&sbl, "safe_bootvol", slot_names[!slot]);
+		if (ret)
+			goto end;
+	}
+
+	ret = env_set(&sbl, "bootvol", slot_names[slot]);
+	if (ret)
+		goto end;
+
+	ret = env_set(&sbl, "tried_to_boot", NULL);
+	if (ret)
+		goto end;
+
+	ret = env_export(&sbl);
+
+end:
+	env_deinit(&sbl);
+
+	return ret;
+}
+
+int fw_slot_read(void *dst, signed long offset, size_t size)
+{
+	uint32_t flash_size = spi_nor_get_size();
+
+	if (offset < 0)
+		offset = (signed long)flash_size + offset;
+
+	return spi_nor_read(dst, (uint32_t)offset, size);
+}
+
+int fw_slot_read_start(void *dst, signed long offset, size_t size)
+{
+	uint32_t flash_size = spi_nor_get_size();
+
+	if (offset < 0)
+		offset = (signed long)flash_size + offset;
+
+	return spi_nor_read_start(dst, (uint32_t)offset, size);
+}
@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: MIT
+// Copyright 2025 RnD Center "ELVEES", JSC
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <libs/platform-def-common.h>
+
+#define FW_SLOT_SIZE (PLAT_OFFSET_FIRMWARE_B - PLAT_OFFSET_FIRMWARE_A)
+
+// Flash offset of the firmware slot, 0 - A, 1 - B
+#define FW_SLOT_OFFSET(slot) (PLAT_OFFSET_FIRMWARE_A + (slot) * FW_SLOT_SIZE)
+
+/**
+ * @brief Take the flash for a service. QSPI0 is shared with the non-secure world, so it's
+ *        initialized again each time.
+ *
+ * @return 0                    - Success,
+ *         -EALREADYINITIALIZED - Flash is used by another service,
+ *         negative error code of spi_nor_init()
+ */
+int fw_slot_flash_acquire(void);
+
+/**
+ * @brief Release the flash taken by fw_slot_flash_acquire()
+ */
+void fw_slot_flash_release(void);
+
+/**
+ * @brief Get the firmware slot which isn't selected for boot. The slot is selected by SBL-S2
+ *        using bootvol variable of SBL environment, slot A is used if it's missing.
+ *
+ * @param slot  - Inactive slot, 0 - A, 1 - B
+ * @param trial - Set if the active slot isn't confirmed yet (bootvol differs from
+ *                safe_bootvol), then the inactive slot is the fallback one
+ *
+ * @return 0 - Success,
+ *         negative error code of env_init()
+ */
+int fw_slot_inactive(int *slot, bool *trial);
+
+/**
+ * @brief Select the slot for the next boot. SBL-S2 falls back to the current slot if
+ *        the selected one fails to boot.
+ *
+ * @param slot - Slot to boot, 0 - A, 1 - B
+ *
+ * @return 0 - Success,
+ *         negative error code of env library
+ */
+int fw_slot_commit(int slot);
+
+// sb_mem_t callbacks reading the flash, negative offset is counted from the flash end
+int fw_slot_read(void *dst, signed long offset, size_t size);
+int fw_slot_read_start(void *dst, signed long offset, size_t size);
@@ -2,15 +2,48 @@
 // Copyright 2025 RnD Center "ELVEES", JSC
 
 #include <stdint.h>
+#include <string.h>
 
+#include <drivers/iommu/iommu.h>
 #include <drivers/mailbox/mailbox.h>
+#include <libs/helpers/helpers.h>
 #include <libs/log.h>
+#include <libs/utils-def.h>
 
 #include "ipc.h"
 #include "protocol.h"
 
 #if defined(BOOTSTAGE_ENABLE)
 #include <libs/bootstage/bootstage.h>
+
+static int bootstage_get_objects(const risc0_ipc_bootstage_get_objects_req_t *req)
+{
+	const struct bootstage_obj_record *rec;
+	iommu_regs_t *iommu = iommu_get_registers();
+	uintptr_t buf;
+	uint32_t count;
+
+	rec = bootstage_obj_get(&count);
+	count = MIN(count, (uint32_t)(req->size / sizeof(*rec)));
+	if (!count)
+		return 0;
+
+	// Protect firmware from writing in it's own address space (first 4 GB)
+	if (req->buf <= UINTPTR_MAX)
+		panic_handler("The address[0x%llx] must be outside 32bit address space\n",
+		              req->buf);
+
+	buf = iommu_map(iommu, req->buf);
+	if (!buf)
+		panic_handler("No free memory\n");
+
+	memcpy((void *)buf, rec, count * sizeof(*rec));
+	wmem_barrier();
+
+	iommu_unmap(iommu, buf);
+
+	return count;
+}
 #endif
 
 void risc0_ipc_bootstage_handler(uint32_t link_id, const risc0_ipc_cmd_t *cmd,
@@ -30,6 +63,10 @@ void risc0_ipc_bootstage_handler(uint32_t link_id, const risc0_ipc_cmd_t *cmd,
 		resp_param->bootstage.get_timestamp.value =
 			bootstage_get_timestamp(cmd->param.bootstage.get_timestamp.id);
 		break;
+	case RISC0_IPC_BOOTSTAGE_FUNC_GET_OBJECTS:
+		resp_param->bootstage.get_objects.count =
+			bootstage_get_objects(&cmd->param.bootstage.get_objects);
+		break;
 	default:
 		ERROR("Unsupported Bootstage command=%d\n", cmd->hdr.func);
 		break;
@@ -26,6 +26,12 @@ void risc0_ipc_init_handler(uint32_t link_id, const risc0_ipc_cmd_t *cmd,
 			resp_param->init.capability.value |= BIT(RISC0_IPC_BOOTSTAGE);
 #endif
 			resp_param->init.capability.value |= BIT(RISC0_IPC_OTP);
+#if defined(SLOT_SCAN_ENABLE)
+			resp_param->init.capability.value |= BIT(RISC0_IPC_SLOT_SCAN);
+#endif
+#if defined(UPDATE_ENABLE)
+			resp_param->init.capability.value |= BIT(RISC0_IPC_UPDATE);
+#endif
 			break;
 		default:
 			break;
@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: MIT
+// Copyright 2025 RnD Center "ELVEES", JSC
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <drivers/mailbox/mailbox.h>
+#include <drivers/spi-nor/spi-nor.h>
+#include <libs/errors.h>
+#include <libs/log.h>
+#include <libs/sbimage/sbexecutor.h>
+#include <libs/sbimage/sbstatus-print.h>
+#include <libs/sbimage/status.h>
+
+#include "api.h"
+#include "fw-slot.h"
+#include "ipc.h"
+#include "protocol.h"
+
+/**
+ * Firmware slot which isn't selected for boot is verified by the check pass of SBIMG executor,
+ * one object per main loop iteration. Requests are handled from read_poll_func while
+ * the payload is read and hashed, so only header parsing and RSA verification delay them.
+ * QSPI0 is shared with the non-secure world, the scan is started by request when the flash
+ * isn't used there.
+ */
+static struct {
+	risc0_ipc_slot_scan_state state;
+	int slot;
+	int objects;
+	int result;
+	// Stop is requested, it's handled when no flash transfer is in progress
+	bool stop;
+} scan = { 0 };
+
+static int scan_read_poll(void)
+{
+	int ret = spi_nor_read_poll();
+
+	if (scan.stop)
+		return (ret) ? ret : -EINVALIDSTATE;
+
+	risc0_ipc_handler();
+
+	return ret;
+}
+
+static int scan_start(void)
+{
+	sb_mem_t sbmem;
+	bool trial;
+	int ret;
+
+	ret = fw_slot_flash_acquire();
+	if (ret)
+		return ret;
+
+	ret = fw_slot_inactive(&scan.slot, &trial);
+	if (ret)
+		goto end;
+
+	scan.objects = 0;
+	scan.result = 0;
+	scan.stop = false;
+
+	memset((void *)&sbmem, 0, sizeof(sbmem));
+	sbmem.cpy_func = (memcopy_t)memcpy;
+	sbmem.read_img_func = (read_img_t)fw_slot_read;
+	sbmem.read_start_func = (read_img_start_t)fw_slot_read_start;
+	sbmem.read_poll_func = (read_img_poll_t)scan_read_poll;
+	sbmem.image_offset = (uintptr_t)FW_SLOT_OFFSET(scan.slot);
+
+	ret = sblimg_init(&sbmem);
+	if (ret != ESBIMGBOOT_NO_ERR)
+		goto end;
+
+	INFO("Firmware %s slot scan is started\n", (scan.slot) ? "B" : "A");
+	scan.state = RISC0_IPC_SLOT_SCAN_STATE_RUNNING;
+	ret = 0;
+
+end:
+	if (ret)
+		fw_slot_flash_release();
+
+	return ret;
+}
+
+void risc0_ipc_slot_scan_step(void)
+{
+	int ret = ESBIMGBOOT_NO_ERR;
+
+	if (scan.state != RISC0_IPC_SLOT_SCAN_STATE_RUNNING)
+		return;
+
+	if (!scan.stop) {
+		ret = sblimg_check();
+		if (ret == ESBIMGBOOT_NO_ERR || ret == ESBIMGBOOT_LOAD_FINISH)
+			scan.objects++;
+	}
+
+	if (ret == ESBIMGBOOT_NO_ERR && !scan.stop)
+		return;
+
+	sblimg_abort();
+	fw_slot_flash_release();
+
+	if (scan.stop) {
+		scan.stop = false;
+		scan.state = RISC0_IPC_SLOT_SCAN_STATE_IDLE;
+		return;
+	}
+
+	// The chain ends with the executable payload, nothing is loaded by the check pass
+	scan.result = (ret == ESBIMGBOOT_LOAD_FINISH) ? 0 : ret;
+	scan.state = RISC0_IPC_SLOT_SCAN_STATE_DONE;
+
+	if (scan.result)
+		sblimg_print_return_code(ret);
+	INFO("Firmware %s slot scan is finished, ret=%d\n", (scan.slot) ? "B" : "A", scan.result);
+}
+
+void risc0_ipc_slot_scan_handler(uint32_t link_id, const risc0_ipc_cmd_t *cmd,
+                                 risc0_ipc_resp_param_t *resp_param)
+{
+	bool secure = (link_id == FIFO4) || (link_id == FIFO5);
+
+	// Status is readable from any world, the scan is started and stopped by secure world only
+	if (!secure && (cmd->hdr.func != RISC0_IPC_SLOT_SCAN_FUNC_GET_STATUS)) {
+		ERROR("Slot scan request is allowed from secure world only\n");
+		if (cmd->hdr.func == RISC0_IPC_SLOT_SCAN_FUNC_START)
+			resp_param->slot_scan.start.error = -EFORBIDDEN;
+		return;
+	}
+
+	switch (cmd->hdr.func) {
+	case RISC0_IPC_SLOT_SCAN_FUNC_START:
+		resp_param->slot_scan.start.error = scan_start();
+		break;
+	case RISC0_IPC_SLOT_SCAN_FUNC_STOP:
+		// Flash is released by the next scan step
+		if (scan.state == RISC0_IPC_SLOT_SCAN_STATE_RUNNING)
+			scan.stop = true;
+		break;
+	case RISC0_IPC_SLOT_SCAN_FUNC_GET_STATUS:
+		resp_param->slot_scan.get_status.state = scan.state;
+		resp_param->slot_scan.get_status.slot = scan.slot;
+		resp_param->slot_scan.get_status.objects = scan.objects;
+		resp_param->slot_scan.get_status.result = scan.result;
+		break;
+	default:
+		ERROR("Unsupported slot scan command=%d\n", cmd->hdr.func);
+		break;
+	}
+}
@@ -0,0 +1,347 @@
+// SPDX-License-Identifier: MIT
+// Copyright 2025 RnD Center "ELVEES", JSC
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <drivers/iommu/iommu.h>
+#include <drivers/mailbox/mailbox.h>
+#include <drivers/spi-nor/spi-nor.h>
+#include <libs/errors.h>
+#include <libs/helpers/helpers.h>
+#include <libs/log.h>
+#include <libs/sbimage/sbexecutor.h>
+#include <libs/sbimage/sbstatus-print.h>
+#include <libs/sbimage/status.h>
+#include <libs/utils-def.h>
+
+#include "api.h"
+#include "fw-slot.h"
+#include "ipc.h"
+#include "protocol.h"
+
+// Image is taken from the ring and written to the flash by pieces of this size
+#define UPDATE_PIECE_SIZE 0x1000
+
+/**
+ * Image streamed by the non-secure world is written to the inactive firmware slot and verified
+ * by the check pass of SBIMG executor at the same time, one object per main loop iteration.
+ * Reads of the executor are served by the pieces taken from the ring, so the flash isn't
+ * read back. Requests are handled from read_poll_func while the executor waits for the data.
+ * The slot is selected for the next boot only if the chain is verified up to the executable
+ * payload and the whole image is written.
+ */
+static struct {
+	risc0_ipc_update_state state;
+	int slot;
+	int objects;
+	int result;
+	// Abort is requested, it's handled by the next update step
+	bool stop;
+	// Chain is verified, the rest of the image is written as is
+	bool verified;
+	// Flash error is kept, as the executor ignores errors of some read_poll_func calls
+	int error;
+	risc0_ipc_update_ring_t *ring;
+	uint32_t data_size;
+	uint32_t image_size;
+	uint32_t written;
+	uint32_t erased;
+	// Read of the executor waiting for the stream
+	uint8_t *dst;
+	uint32_t pos;
+	uint32_t len;
+} update = { 0 };
+
+// Piece is copied from the shared memory, so the flash gets the data given to the executor
+static uint8_t piece[UPDATE_PIECE_SIZE];
+
+static int update_write(void)
+{
+	uint32_t offset = FW_SLOT_OFFSET(update.slot);
+	uint32_t head;
+	uint32_t index;
+	uint32_t size;
+	int ret;
+
+	rmem_barrier();
+	head = MIN(update.ring->head, update.image_size);
+	if (head <= update.written)
+		return 0;
+
+	index = update.written % update.data_size;
+	size = MIN(head - update.written, update.data_size - index);
+	size = MIN(size, (uint32_t)UPDATE_PIECE_SIZE);
+	memcpy(piece, &update.ring->data[index], size);
+
+	// Sector is erased when the image reaches it, the piece never crosses two sectors
+	if (update.written + size > update.erased) {
+		ret = spi_nor_erase(offset + update.erased, 1);
+		if (ret)
+			return ret;
+		update.erased += spi_nor_get_sector_size();
+	}
+
+	ret = spi_nor_write(piece, offset + update.written, size);
+	if (ret)
+		return ret;
+
+	if (update.len && update.pos >= update.written && update.pos < update.written + size) {
+		uint32_t len = MIN(update.len, update.written + size - update.pos);
+
+		memcpy(update.dst, &piece[update.pos - update.written], len);
+		update.dst += len;
+		update.pos += len;
+		update.len -= len;
+	}
+
+	update.written += size;
+	update.ring->tail = update.written;
+	wmem_barrier();
+
+	return 0;
+}
+
+static int update_read_poll(void)
+{
+	if (update.stop)
+		return -EINVALIDSTATE;
+
+	if (!update.error)
+		update.error = update_write();
+	if (update.error)
+		return update.error;
+
+	risc0_ipc_handler();
+
+	return update.len;
+}
+
+static int update_read_start(void *dst, signed long offset, size_t size)
+{
+	uint32_t pos = (uint32_t)offset - FW_SLOT_OFFSET(update.slot);
+	uint8_t *buf = (uint8_t *)dst;
+	int ret;
+
+	update.len = 0;
+
+	// Executor reads ahead beyond the image, the slot is erased there
+	if (pos >= update.image_size) {
+		memset(buf, 0xFF, size);
+		return 0;
+	}
+
+	if (size > update.image_size - pos) {
+		memset(buf + update.image_size - pos, 0xFF, size - (update.image_size - pos));
+		size = update.image_size - pos;
+	}
+
+	// Data received before is read from the flash
+	if (pos < update.written) {
+		uint32_t len = MIN((uint32_t)size, update.written - pos);
+
+		ret = fw_slot_read(buf, FW_SLOT_OFFSET(update.slot) + pos, len);
+		if (ret)
+			return ret;
+
+		buf += len;
+		pos += len;
+		size -= len;
+	}
+
+	update.dst = buf;
+	update.pos = pos;
+	update.len = size;
+
+	return update_read_poll();
+}
+
+static int update_read(void *dst, signed long offset, size_t size)
+{
+	int ret = update_read_start(dst, offset, size);
+
+	while (ret > 0)
+		ret = update_read_poll();
+
+	return ret;
+}
+
+static void update_finish(int ret)
+{
+	sblimg_abort();
+
+	iommu_unmap(iommu_get_registers(), (uintptr_t)update.ring);
+	update.ring = NULL;
+
+	fw_slot_flash_release();
+
+	if (update.stop) {
+		update.stop = false;
+		update.state = RISC0_IPC_UPDATE_STATE_IDLE;
+		INFO("Firmware %s slot update is aborted\n", (update.slot) ? "B" : "A");
+		return;
+	}
+
+	update.result = ret;
+	update.state = RISC0_IPC_UPDATE_STATE_DONE;
+
+	if (update.result)
+		sblimg_print_return_code(ret);
+	INFO("Firmware %s slot update is finished, ret=%d\n", (update.slot) ? "B" : "A",
+	     update.result);
+}
+
+static int update_start(const risc0_ipc_update_start_req_t *req)
+{
+	iommu_regs_t *iommu = iommu_get_registers();
+	sb_mem_t sbmem;
+	bool trial;
+	int ret;
+
+	if (req->size <= sizeof(risc0_ipc_update_ring_t) ||
+	    req->size > RISC0_IPC_UPDATE_RING_MAX_SIZE)
+		return -EINVALIDLENGTH;
+
+	// Protect firmware from writing in it's own address space (first 4 GB)
+	if (req->buf <= UINTPTR_MAX)
+		panic_handler("The address[0x%llx] must be outside 32bit address space\n",
+		              req->buf);
+
+	ret = fw_slot_flash_acquire();
+	if (ret)
+		return ret;
+
+	ret = fw_slot_inactive(&update.slot, &trial);
+	if (ret)
+		goto end;
+
+	// Inactive slot is the fallback one until the active slot is confirmed
+	if (trial) {
+		ret = -EINVALIDSTATE;
+		goto end;
+	}
+
+	update.ring = (risc0_ipc_update_ring_t *)iommu_map(iommu, req->buf);
+	if (!update.ring)
+		panic_handler("No free memory\n");
+
+	rmem_barrier();
+	update.image_size = update.ring->image_size;
+	if (!update.image_size || update.image_size > FW_SLOT_SIZE) {
+		ret = -EINVALIDLENGTH;
+		goto end;
+	}
+
+	update.data_size = req->size - sizeof(risc0_ipc_update_ring_t);
+	update.written = 0;
+	update.erased = 0;
+	update.objects = 0;
+	update.result = 0;
+	update.stop = false;
+	update.verified = false;
+	update.error = 0;
+	update.len = 0;
+
+	update.ring->tail = 0;
+	wmem_barrier();
+
+	memset((void *)&sbmem, 0, sizeof(sbmem));
+	sbmem.cpy_func = (memcopy_t)memcpy;
+	sbmem.read_img_func = (read_img_t)update_read;
+	sbmem.read_start_func = (read_img_start_t)update_read_start;
+	sbmem.read_poll_func = (read_img_poll_t)update_read_poll;
+	sbmem.image_offset = (uintptr_t)FW_SLOT_OFFSET(update.slot);
+
+	ret = sblimg_init(&sbmem);
+	if (ret != ESBIMGBOOT_NO_ERR)
+		goto end;
+
+	INFO("Firmware %s slot update is started, %lu bytes\n", (update.slot) ? "B" : "A",
+	     update.image_size);
+	update.state = RISC0_IPC_UPDATE_STATE_RUNNING;
+	ret = 0;
+
+end:
+	if (ret) {
+		if (update.ring)
+			iommu_unmap(iommu, (uintptr_t)update.ring);
+		update.ring = NULL;
+		fw_slot_flash_release();
+	}
+
+	return ret;
+}
+
+void risc0_ipc_update_step(void)
+{
+	int ret;
+
+	if (update.state != RISC0_IPC_UPDATE_STATE_RUNNING)
+		return;
+
+	if (update.stop) {
+		update_finish(0);
+		return;
+	}
+
+	if (!update.verified) {
+		ret = sblimg_check();
+		if (ret == ESBIMGBOOT_NO_ERR || ret == ESBIMGBOOT_LOAD_FINISH)
+			update.objects++;
+
+		if (ret == ESBIMGBOOT_NO_ERR)
+			return;
+
+		// The chain ends with the executable payload, nothing is loaded by the check pass
+		if (ret != ESBIMGBOOT_LOAD_FINISH) {
+			update_finish(ret);
+			return;
+		}
+
+		update.verified = true;
+	}
+
+	ret = update_write();
+	if (ret) {
+		update_finish(ret);
+		return;
+	}
+
+	if (update.written < update.image_size)
+		return;
+
+	update_finish(fw_slot_commit(update.slot));
+}
+
+void risc0_ipc_update_handler(uint32_t link_id, const risc0_ipc_cmd_t *cmd,
+                              risc0_ipc_resp_param_t *resp_param)
+{
+	if ((link_id != FIFO4) && (link_id != FIFO5)) {
+		ERROR("Update request is allowed from secure world only\n");
+		return;
+	}
+
+	switch (cmd->hdr.func) {
+	case RISC0_IPC_UPDATE_FUNC_START:
+		if (update.state == RISC0_IPC_UPDATE_STATE_RUNNING)
+			resp_param->update.start.error = -EALREADYINITIALIZED;
+		else
+			resp_param->update.start.error = update_start(&cmd->param.update.start);
+		break;
+	case RISC0_IPC_UPDATE_FUNC_ABORT:
+		// Flash and shared memory are released by the next update step
+		if (update.state == RISC0_IPC_UPDATE_STATE_RUNNING)
+			update.stop = true;
+		break;
+	case RISC0_IPC_UPDATE_FUNC_GET_STATUS:
+		resp_param->update.get_status.state = update.state;
+		resp_param->update.get_status.slot = update.slot;
+		resp_param->update.get_status.objects = update.objects;
+		resp_param->update.get_status.result = update.result;
+		break;
+	default:
+		ERROR("Unsupported update command=%d\n", cmd->hdr.func);
+		break;
+	}
+}
@@ -22,6 +22,14 @@ void risc0_ipc_wdt_handler(uint32_t link_id, const risc0_ipc_cmd_t *cmd,
 void risc0_ipc_bootstage_handler(uint32_t link_id, const risc0_ipc_cmd_t *cmd,
                                  risc0_ipc_resp_param_t *resp_param);
 
+void risc0_ipc_slot_scan_handler(uint32_t link_id, const risc0_ipc_cmd_t *cmd,
+                                 risc0_ipc_resp_param_t *resp_param);
+void risc0_ipc_slot_scan_step(void);
+
+void risc0_ipc_update_handler(uint32_t link_id, const risc0_ipc_cmd_t *cmd,
+                              risc0_ipc_resp_param_t *resp_param);
+void risc0_ipc_update_step(void);
+
 int risc0_ipc_otp_init(void);
 void risc0_ipc_otp_handler(uint32_t link_id, const risc0_ipc_cmd_t *cmd,
                            risc0_ipc_resp_param_t *resp_param);
@@ -15,6 +15,8 @@ typedef enum {
 	RISC0_IPC_DDR_SUBS = 0x05U,
 	RISC0_IPC_BOOTSTAGE = 0x06U,
 	RISC0_IPC_OTP = 0x07U,
+	RISC0_IPC_SLOT_SCAN = 0x08U,
+	RISC0_IPC_UPDATE = 0x09U,
 	RISC0_IPC_COUNT,
 } risc0_ipc;
 
@@ -52,6 +54,7 @@ typedef enum {
 typedef enum {
 	RISC0_IPC_BOOTSTAGE_FUNC_SET_STAGE = 0x01U,
 	RISC0_IPC_BOOTSTAGE_FUNC_GET_TIMESTAMP = 0x02U,
+	RISC0_IPC_BOOTSTAGE_FUNC_GET_OBJECTS = 0x03U,
 	RISC0_IPC_BOOTSTAGE_FUNC_COUNT,
 } risc0_ipc_bootstage_func;
 
@@ -60,9 +63,42 @@ typedef enum {
 	RISC0_IPC_OTP_FUNC_COUNT,
 } risc0_ipc_otp_func;
 
+typedef enum {
+	RISC0_IPC_SLOT_SCAN_FUNC_START = 0x01U,
+	RISC0_IPC_SLOT_SCAN_FUNC_STOP = 0x02U,
+	RISC0_IPC_SLOT_SCAN_FUNC_GET_STATUS = 0x03U,
+	RISC0_IPC_SLOT_SCAN_FUNC_COUNT,
+} risc0_ipc_slot_scan_func;
+
+typedef enum {
+	RISC0_IPC_SLOT_SCAN_STATE_IDLE = 0x00U,
+	RISC0_IPC_SLOT_SCAN_STATE_RUNNING = 0x01U,
+	RISC0_IPC_SLOT_SCAN_STATE_DONE = 0x02U,
+	RISC0_IPC_SLOT_SCAN_STATE_COUNT,
+} risc0_ipc_slot_scan_state;
+
+typedef enum {
+	RISC0_IPC_UPDATE_FUNC_START = 0x01U,
+	RISC0_IPC_UPDATE_FUNC_ABORT = 0x02U,
+	RISC0_IPC_UPDATE_FUNC_GET_STATUS = 0x03U,
+	RISC0_IPC_UPDATE_FUNC_COUNT,
+} risc0_ipc_update_func;
+
+typedef enum {
+	RISC0_IPC_UPDATE_STATE_IDLE = 0x00U,
+	RISC0_IPC_UPDATE_STATE_RUNNING = 0x01U,
+	RISC0_IPC_UPDATE_STATE_DONE = 0x02U,
+	RISC0_IPC_UPDATE_STATE_COUNT,
+} risc0_ipc_update_state;
+
+// Shared memory of the update stream including the header, it's mapped by one IOMMU slot
+#define RISC0_IPC_UPDATE_RING_MAX_SIZE 0x100000
+
 typedef enum {
 	RISC0_IPC_RESP_STATE_BUSY = 0x00U,
 	RISC0_IPC_RESP_STATE_COMPLETE = 0x01U,
+	// Request isn't handled, too many requests of the link are waiting, params are zero
+	RISC0_IPC_RESP_STATE_DROPPED = 0x02U,
 	RISC0_IPC_RESP_STATE_COUNT,
 } risc0_ipc_resp_state;
 
@@ -96,11 +132,23 @@ typedef struct {
 	uint32_t id;
 } risc0_ipc_bootstage_get_timestamp_req_t;
 
+// Buffer receives array of struct bootstage_obj_record, one per SBIMG object processed by SBL-S2
+typedef struct {
+	uint64_t buf;
+	uint32_t size;
+} risc0_ipc_bootstage_get_objects_req_t;
+
 typedef struct {
 	uint64_t buf;
 	uint32_t size;
 } risc0_ipc_otp_get_dump_req_t;
 
+// Buffer contains risc0_ipc_update_ring_t, size includes its header
+typedef struct {
+	uint64_t buf;
+	uint32_t size;
+} risc0_ipc_update_start_req_t;
+
 typedef union {
 	risc0_ipc_reserved_t reserved;
 	union {
@@ -116,10 +164,14 @@ typedef union {
 	union {
 		risc0_ipc_bootstage_set_stage_t set_stage;
 		risc0_ipc_bootstage_get_timestamp_req_t get_timestamp;
+		risc0_ipc_bootstage_get_objects_req_t get_objects;
 	} bootstage;
 	union {
 		risc0_ipc_otp_get_dump_req_t get_dump;
 	} otp;
+	union {
+		risc0_ipc_update_start_req_t start;
+	} update;
 } risc0_ipc_cmd_param_t;
 
 // Response params
@@ -151,10 +203,48 @@ typedef struct {
 	long long value;
 } risc0_ipc_bootstage_get_timestamp_res_t;
 
+// Number of copied records or negative error code
+typedef struct {
+	int count;
+} risc0_ipc_bootstage_get_objects_res_t;
+
 typedef struct {
 	int error;
 } risc0_ipc_otp_get_dump_res_t;
 
+// Scan of the inactive slot is started, 0 or negative error code (-EFORBIDDEN for non-secure)
+typedef struct {
+	int error;
+} risc0_ipc_slot_scan_start_res_t;
+
+/**
+ * Result is 0 if the slot contains a chain verified up to the executable payload,
+ * SBIMG status or negative error code otherwise. It's valid in DONE state only.
+ */
+typedef struct {
+	uint8_t state;
+	uint8_t slot; // 0 - A, 1 - B
+	uint16_t objects; // Number of objects verified so far
+	int result;
+} risc0_ipc_slot_scan_get_status_res_t;
+
+// Update of the inactive slot is started, 0 or negative error code
+typedef struct {
+	int error;
+} risc0_ipc_update_start_res_t;
+
+/**
+ * Result is 0 if the image is written, verified up to the executable payload and the slot
+ * is selected for the next boot, SBIMG status or negative error code otherwise. It's valid
+ * in DONE state only.
+ */
+typedef struct {
+	uint8_t state;
+	uint8_t slot; // 0 - A, 1 - B
+	uint16_t objects; // Number of objects verified so far
+	int result;
+} risc0_ipc_update_get_status_res_t;
+
 typedef union {
 	union {
 		risc0_ipc_init_get_capability_t capability;
@@ -170,10 +260,19 @@ typedef union {
 	} pm;
 	union {
 		risc0_ipc_bootstage_get_timestamp_res_t get_timestamp;
+		risc0_ipc_bootstage_get_objects_res_t get_objects;
 	} bootstage;
 	union {
 		risc0_ipc_otp_get_dump_res_t get_dump;
 	} otp;
+	union {
+		risc0_ipc_slot_scan_start_res_t start;
+		risc0_ipc_slot_scan_get_status_res_t get_status;
+	} slot_scan;
+	union {
+		risc0_ipc_update_start_res_t start;
+		risc0_ipc_update_get_status_res_t get_status;
+	} update;
 } risc0_ipc_resp_param_t;
 
 // Command message
@@ -212,4 +311,17 @@ typedef struct {
 	risc0_ipc_cmd_t cmd;
 	risc0_ipc_shrmem_t shrmem;
 } risc0_ipc_req_t;
+
+/**
+ * Stream of SBIMG image written to the inactive slot. Producer puts the image to data
+ * as to the ring buffer and advances head, SBL-S3 advances tail when the data is written
+ * to the flash. Both are offsets in the image, the data is at offset % data size.
+ */
+typedef struct {
+	uint32_t image_size;
+	volatile uint32_t head;
+	volatile uint32_t tail;
+	uint32_t reserved;
+	uint8_t data[];
+} risc0_ipc_update_ring_t;
 #pragma pack(pop)
@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: MIT
+// Copyright 2025 RnD Center "ELVEES", JSC
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include <gtest/gtest.h>
+#include <third-party/aes/aes.h>
+
+// NIST SP 800-38A, F.1.1 and F.2.1
+static const uint8_t key[AES_KEYLEN] = {
+	0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c,
+};
+
+static const uint8_t iv[AES_BLOCKLEN] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+};
+
+static const uint8_t plain[4 * AES_BLOCKLEN] = {
+	0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+	0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+	0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+	0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10,
+};
+
+static const uint8_t ecb_cipher[4 * AES_BLOCKLEN] = {
+	0x3a, 0xd7, 0x7b, 0xb4, 0x0d, 0x7a, 0x36, 0x60, 0xa8, 0x9e, 0xca, 0xf3, 0x24, 0x66, 0xef, 0x97,
+	0xf5, 0xd3, 0xd5, 0x85, 0x03, 0xb9, 0x69, 0x9d, 0xe7, 0x85, 0x89, 0x5a, 0x96, 0xfd, 0xba, 0xaf,
+	0x43, 0xb1, 0xcd, 0x7f, 0x59, 0x8e, 0xce, 0x23, 0x88, 0x1b, 0x00, 0xe3, 0xed, 0x03, 0x06, 0x88,
+	0x7b, 0x0c, 0x78, 0x5e, 0x27, 0xe8, 0xad, 0x3f, 0x82, 0x23, 0x20, 0x71, 0x04, 0x72, 0x5d, 0xd4,
+};
+
+static const uint8_t cbc_cipher[4 * AES_BLOCKLEN] = {
+	0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46, 0xce, 0xe9, 0x8e, 0x9b, 0x12, 0xe9, 0x19, 0x7d,
+	0x50, 0x86, 0xcb, 0x9b, 0x50, 0x72, 0x19, 0xee, 0x95, 0xdb, 0x11, 0x3a, 0x91, 0x76, 0x78, 0xb2,
+	0x73, 0xbe, 0xd6, 0xb8, 0xe3, 0xc1, 0x74, 0x3b, 0x71, 0x16, 0xe6, 0x9e, 0x22, 0x22, 0x95, 0x16,
+	0x3f, 0xf1, 0xca, 0xa1, 0x68, 0x1f, 0xac, 0x09, 0x12, 0x0e, 0xca, 0x30, 0x75, 0x86, 0xe1, 0xa7,
+};
+
+TEST(AesTests, known_answers)
+{
+	uint8_t buf[sizeof(plain)];
+
+	for (size_t i = 0; i < sizeof(plain); i += AES_BLOCKLEN) {
+		AES_ECB_encrypt_wrap(&plain[i], key, buf, AES_BLOCKLEN);
+		GTEST_ASSERT_EQ(memcmp(buf, &ecb_cipher[i], AES_BLOCKLEN), 0);
+		AES_ECB_decrypt_wrap(&ecb_cipher[i], key, buf, AES_BLOCKLEN);
+		GTEST_ASSERT_EQ(memcmp(buf, &plain[i], AES_BLOCKLEN), 0);
+	}
+
+	AES_CBC_encrypt_buffer_wrap(buf, plain, sizeof(plain), key, iv);
+	GTEST_ASSERT_EQ(memcmp(buf, cbc_cipher, sizeof(cbc_cipher)), 0);
+	AES_CBC_decrypt_buffer_wrap(buf, cbc_cipher, sizeof(cbc_cipher), key, iv);
+	GTEST_ASSERT_EQ(memcmp(buf, plain, sizeof(plain)), 0);
+}
+
+TEST(AesTests, cbc_decrypt_by_slices)
+{
+	static uint8_t data[1024], buf[1024];
+	uint8_t k[AES_KEYLEN], v[AES_BLOCKLEN];
+	uint32_t seed = 0xA5A5F00D;
+
+	for (int n = 0; n < 50; n++) {
+		for (size_t i = 0; i < sizeof(data); i++) {
+			seed = seed * 1103515245 + 12345;
+			data[i] = seed >> 16;
+		}
+		memcpy(k, data, sizeof(k));
+		memcpy(v, data + sizeof(k), sizeof(v));
+
+		// Encryption is the byte-oriented reference cipher, IV is carried between slices
+		struct AES_ctx ctx;
+		size_t slice = AES_BLOCKLEN * (1 + n % 7);
+
+		AES_CBC_encrypt_buffer_wrap(buf, data, sizeof(data), k, v);
+		AES_init_ctx_iv(&ctx, k, v);
+		for (size_t offset = 0; offset < sizeof(buf); offset += slice)
+			AES_CBC_decrypt_buffer(&ctx, buf + offset, std::min(slice, sizeof(buf) - offset));
+		GTEST_ASSERT_EQ(memcmp(buf, data, sizeof(data)), 0);
+	}
+}
@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: MIT
+// Copyright 2025 RnD Center "ELVEES", JSC
+
+#include <stdint.h>
+#include <string.h>
+
+#include <gtest/gtest.h>
+#include <third-party/crypto/crypto.h>
+
+#define RSA_BYTES 384
+#define ROW_COMPS 12
+
+static uint32_t seed;
+
+static uint32_t next_random(void)
+{
+	// xorshift32, the sequence is the same on every run
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+static void fill_random(uint8_t *buf, size_t size)
+{
+	for (size_t i = 0; i < size; i++)
+		buf[i] = next_random();
+}
+
+// Reference row multiply-accumulate by 16-bit halves of the components
+static comp ref_mul_add_row(comp *r, const comp *a, int n, comp b)
+{
+	uint32_t acc[2 * ROW_COMPS + 2] = { 0 };
+	comp carry = 0;
+
+	for (int j = 0; j < n; j++) {
+		acc[2 * j] += r[j] & 0xFFFF;
+		acc[2 * j + 1] += r[j] >> 16;
+		for (int x = 0; x < 2; x++)
+			for (int y = 0; y < 2; y++) {
+				uint32_t ax = (a[j] >> (16 * x)) & 0xFFFF;
+				uint32_t by = (b >> (16 * y)) & 0xFFFF;
+				uint32_t p = ax * by;
+
+				acc[2 * j + x + y] += p & 0xFFFF;
+				acc[2 * j + x + y + 1] += p >> 16;
+			}
+	}
+
+	for (int i = 0; i < 2 * n + 1; i++) {
+		acc[i + 1] += acc[i] >> 16;
+		acc[i] &= 0xFFFF;
+	}
+
+	for (int j = 0; j < n; j++)
+		r[j] = acc[2 * j] | (acc[2 * j + 1] << 16);
+	carry = acc[2 * n] | (acc[2 * n + 1] << 16);
+
+	return carry;
+}
+
+static bigint *import_random(BI_CTX *ctx, bool top_bit, bool odd)
+{
+	uint8_t buf[RSA_BYTES];
+
+	fill_random(buf, sizeof(buf));
+	if (top_bit)
+		buf[0] |= 0x80;
+	else
+		buf[0] &= 0x7F;
+	if (odd)
+		buf[RSA_BYTES - 1] |= 1;
+
+	return bi_import(ctx, buf, sizeof(buf));
+}
+
+static void expect_equal(BI_CTX *ctx, bigint *a, bigint *b)
+{
+	uint8_t buf_a[RSA_BYTES];
+	uint8_t buf_b[RSA_BYTES];
+
+	// bi_export() frees the bigints
+	bi_export(ctx, a, buf_a, sizeof(buf_a));
+	bi_export(ctx, b, buf_b, sizeof(buf_b));
+	GTEST_ASSERT_EQ(memcmp(buf_a, buf_b, RSA_BYTES), 0);
+}
+
+TEST(BigintTests, mul_add_row)
+{
+	comp r[ROW_COMPS], a[ROW_COMPS], ref[ROW_COMPS];
+
+	// (2^(32n) - 1) + (2^(32n) - 1) * (2^32 - 1) = (2^(32n) - 1) * 2^32
+	for (int i = 0; i < ROW_COMPS; i++)
+		r[i] = a[i] = 0xFFFFFFFF;
+	GTEST_ASSERT_EQ(bi_mul_add_row(r, a, ROW_COMPS, 0xFFFFFFFF), 0xFFFFFFFF);
+	GTEST_ASSERT_EQ(r[0], 0);
+	for (int i = 1; i < ROW_COMPS; i++)
+		GTEST_ASSERT_EQ(r[i], 0xFFFFFFFF);
+
+	GTEST_ASSERT_EQ(bi_mul_add_row(r, a, 0, 0xFFFFFFFF), 0);
+
+	seed = 0x12345678;
+	for (int k = 0; k < 1000; k++) {
+		int n = 1 + next_random() % ROW_COMPS;
+		comp b = next_random();
+
+		for (int i = 0; i < n; i++) {
+			r[i] = ref[i] = next_random();
+			a[i] = next_random();
+		}
+
+		GTEST_ASSERT_EQ(bi_mul_add_row(r, a, n, b), ref_mul_add_row(ref, a, n, b));
+		GTEST_ASSERT_EQ(memcmp(r, ref, n * sizeof(comp)), 0);
+	}
+}
+
+TEST(BigintTests, barrett_matches_classical)
+{
+	BI_CTX *ctx = bi_initialize();
+
+	seed = 0xCAFEF00D;
+	bi_set_mod(ctx, import_random(ctx, true, true), BIGINT_M_OFFSET);
+	ctx->mod_offset = BIGINT_M_OFFSET;
+
+	for (int k = 0; k < 20; k++) {
+		bigint *a = import_random(ctx, false, false);
+		bigint *b = import_random(ctx, false, false);
+		bigint *product = bi_multiply(ctx, a, b);
+
+		// Barrett reduction uses partial products, classical one uses division
+		expect_equal(ctx, bi_residue(ctx, bi_copy(product)), bi_mod(ctx, product));
+	}
+
+	bi_free_mod(ctx, BIGINT_M_OFFSET);
+	bi_terminate(ctx);
+}
+
+TEST(BigintTests, mod_power_f4)
+{
+	BI_CTX *ctx = bi_initialize();
+	const uint8_t f4[] = { 0x01, 0x00, 0x01 };
+
+	seed = 0xDEADBEEF;
+	bi_set_mod(ctx, import_random(ctx, true, true), BIGINT_M_OFFSET);
+	ctx->mod_offset = BIGINT_M_OFFSET;
+
+	for (int k = 0; k < 4; k++) {
+		bigint *x = import_random(ctx, false, false);
+		bigint *r = bi_copy(x);
+
+		// x^65537 = x^(2^16) * x
+		for (int i = 0; i < 16; i++)
+			r = bi_mod(ctx, bi_square(ctx, r));
+		r = bi_mod(ctx, bi_multiply(ctx, r, bi_copy(x)));
+
+		expect_equal(ctx, bi_mod_power(ctx, x, bi_import(ctx, f4, sizeof(f4))), r);
+	}
+
+	bi_free_mod(ctx, BIGINT_M_OFFSET);
+	bi_terminate(ctx);
+}
+
+TEST(BigintTests, arena_capacity)
+{
+	BI_CTX *ctx = bi_initialize();
+	static uint8_t buf[3 * RSA_BYTES];
+	static bigint *held[1024];
+	int n = 0;
+
+	// Intermediates are limited by the slot size
+	GTEST_ASSERT_EQ(bi_import(ctx, buf, sizeof(buf)), nullptr);
+
+	while (n < 1024 && (held[n] = int_to_bi(ctx, n)) != NULL)
+		n++;
+	GTEST_ASSERT_LT(n, 1024);
+
+	// Released slots are given back to the arena and can be taken by another context
+	for (int i = 0; i < n; i++)
+		bi_free(ctx, held[i]);
+	bi_terminate(ctx);
+
+	ctx = bi_initialize();
+	for (int i = 0; i < n; i++) {
+		held[i] = int_to_bi(ctx, i);
+		GTEST_ASSERT_NE(held[i], nullptr);
+	}
+	for (int i = 0; i < n; i++)
+		bi_free(ctx, held[i]);
+	bi_terminate(ctx);
+}
@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: MIT
+// Copyright 2025 RnD Center "ELVEES", JSC
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include <gtest/gtest.h>
+#include <libs/lz4/lz4.h>
+
+#define CONTENT_SIZE 320
+#define TEXT_SIZE    256
+
+/**
+ * Frames are made by lz4 command line tool from content() output:
+ * linked blocks with block checksums: lz4 -9 --content-size -BX -BD --no-frame-crc
+ * raw block with content checksum: lz4 --content-size (the last 64 bytes only)
+ */
+static const uint8_t frame_linked[113] = {
+	0x04, 0x22, 0x4d, 0x18, 0x78, 0x40, 0x40, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe9, 0x56,
+	0x00, 0x00, 0x00, 0xff, 0x00, 0x45, 0x4c, 0x56, 0x45, 0x45, 0x53, 0x20, 0x53, 0x42, 0x4c, 0x20,
+	0x4c, 0x5a, 0x34, 0x20, 0x0f, 0x00, 0xde, 0xf0, 0x31, 0x00, 0x40, 0x80, 0xc1, 0x02, 0x43, 0x84,
+	0xc6, 0x08, 0x4a, 0x8c, 0xcf, 0x12, 0x55, 0x98, 0xdc, 0x20, 0x64, 0xa8, 0xed, 0x32, 0x77, 0xbc,
+	0x02, 0x48, 0x8e, 0xd4, 0x1b, 0x62, 0xa9, 0xf0, 0x38, 0x80, 0xc8, 0x10, 0x59, 0xa2, 0xeb, 0x34,
+	0x7e, 0xc8, 0x12, 0x5c, 0xa7, 0xf2, 0x3d, 0x88, 0xd4, 0x20, 0x6c, 0xb8, 0x05, 0x52, 0x9f, 0xec,
+	0x3a, 0x88, 0xd6, 0x24, 0x73, 0xc2, 0x11, 0x60, 0xb0, 0xc9, 0x2b, 0xa5, 0x04, 0x00, 0x00, 0x00,
+	0x00,
+};
+
+static const uint8_t frame_raw[91] = {
+	0x04, 0x22, 0x4d, 0x18, 0x6c, 0x40, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xda, 0x40,
+	0x00, 0x00, 0x80, 0x00, 0x40, 0x80, 0xc1, 0x02, 0x43, 0x84, 0xc6, 0x08, 0x4a, 0x8c, 0xcf, 0x12,
+	0x55, 0x98, 0xdc, 0x20, 0x64, 0xa8, 0xed, 0x32, 0x77, 0xbc, 0x02, 0x48, 0x8e, 0xd4, 0x1b, 0x62,
+	0xa9, 0xf0, 0x38, 0x80, 0xc8, 0x10, 0x59, 0xa2, 0xeb, 0x34, 0x7e, 0xc8, 0x12, 0x5c, 0xa7, 0xf2,
+	0x3d, 0x88, 0xd4, 0x20, 0x6c, 0xb8, 0x05, 0x52, 0x9f, 0xec, 0x3a, 0x88, 0xd6, 0x24, 0x73, 0xc2,
+	0x11, 0x60, 0xb0, 0x00, 0x00, 0x00, 0x00, 0x58, 0xff, 0x58, 0x46,
+};
+
+// Repeated text followed by poorly compressible bytes
+static void content(uint8_t *buf)
+{
+	const char *text = "ELVEES SBL LZ4 ";
+
+	for (int i = 0; i < CONTENT_SIZE; i++)
+		buf[i] = (i < TEXT_SIZE) ? text[i % strlen(text)] : (uint8_t)((i * i) >> 3);
+}
+
+// Decode the frame by pieces of the given size, return 0 if the whole frame is decoded
+static int decode(const uint8_t *frame, size_t size, size_t piece, uint8_t *dst)
+{
+	lz4_stream_t s;
+
+	lz4_stream_init(&s, dst);
+	for (size_t pos = 0; pos < size;) {
+		int ret = lz4_stream_decode(&s, frame + pos, std::min(piece, size - pos));
+		if (ret < 0)
+			return ret;
+		pos += ret;
+	}
+
+	return lz4_stream_done(&s) ? 0 : -1;
+}
+
+TEST(Lz4Tests, header_stops_decoding)
+{
+	uint8_t dst[CONTENT_SIZE];
+	lz4_stream_t s;
+
+	lz4_stream_init(&s, NULL);
+	ASSERT_EQ(lz4_stream_decode(&s, frame_linked, 10), 10);
+	ASSERT_FALSE(lz4_stream_has_header(&s));
+	ASSERT_EQ(lz4_stream_decode(&s, frame_linked + 10, sizeof(frame_linked) - 10), 5);
+	ASSERT_TRUE(lz4_stream_has_header(&s));
+	ASSERT_EQ(s.dst_size, (size_t)CONTENT_SIZE);
+
+	s.dst = dst;
+	ASSERT_EQ(lz4_stream_decode(&s, frame_linked + 15, sizeof(frame_linked) - 15),
+	          (int)sizeof(frame_linked) - 15);
+	ASSERT_TRUE(lz4_stream_done(&s));
+}
+
+TEST(Lz4Tests, streaming_by_pieces)
+{
+	uint8_t ref[CONTENT_SIZE], dst[CONTENT_SIZE];
+
+	content(ref);
+	for (size_t piece : { 1, 2, 3, 7, 16, 64, 1024 }) {
+		memset(dst, 0, sizeof(dst));
+		ASSERT_EQ(decode(frame_linked, sizeof(frame_linked), piece, dst), 0) << piece;
+		ASSERT_EQ(memcmp(dst, ref, sizeof(ref)), 0) << piece;
+
+		memset(dst, 0, sizeof(dst));
+		ASSERT_EQ(decode(frame_raw, sizeof(frame_raw), piece, dst), 0) << piece;
+		ASSERT_EQ(memcmp(dst, ref + TEXT_SIZE, CONTENT_SIZE - TEXT_SIZE), 0) << piece;
+	}
+}
+
+TEST(Lz4Tests, malformed_frames)
+{
+	uint8_t frame[sizeof(frame_linked) + 1];
+	uint8_t dst[CONTENT_SIZE];
+
+	// Content size isn't specified
+	memcpy(frame, frame_linked, sizeof(frame_linked));
+	frame[4] &= ~0x08;
+	ASSERT_LT(decode(frame, sizeof(frame_linked), 1024, dst), 0);
+
+	// Output overflows the content size
+	memcpy(frame, frame_linked, sizeof(frame_linked));
+	frame[6]--;
+	ASSERT_LT(decode(frame, sizeof(frame_linked), 1024, dst), 0);
+
+	// Match refers before the start of the output
+	memcpy(frame, frame_linked, sizeof(frame_linked));
+	frame[36]++;
+	ASSERT_LT(decode(frame, sizeof(frame_linked), 1024, dst), 0);
+
+	// Data after the end mark
+	memcpy(frame, frame_linked, sizeof(frame_linked));
+	frame[sizeof(frame_linked)] = 0;
+	ASSERT_LT(decode(frame, sizeof(frame), 1024, dst), 0);
+
+	// Truncated frame
+	ASSERT_NE(decode(frame_linked, sizeof(frame_linked) - 1, 1024, dst), 0);
+}
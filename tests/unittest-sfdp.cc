@@ -0,0 +1,156 @@
+// SPDX-License-Identifier: MIT
+// Copyright 2025 RnD Center "ELVEES", JSC
+
+#include <stdint.h>
+#include <string.h>
+
+#include <drivers/spi-nor/sfdp.h>
+#include <gtest/gtest.h>
+#include <libs/errors.h>
+
+#define BFPT_ADDR     0x30
+#define FOURBAIT_ADDR 0x80
+
+static uint8_t sfdp_image[0x100];
+
+static int sfdp_read(uint32_t address, void *buffer, uint32_t size)
+{
+	if (address + size > sizeof(sfdp_image))
+		return -EINVALIDADDR;
+
+	memcpy(buffer, &sfdp_image[address], size);
+
+	return 0;
+}
+
+static void put_le32(uint8_t *p, uint32_t val)
+{
+	p[0] = val;
+	p[1] = val >> 8;
+	p[2] = val >> 16;
+	p[3] = val >> 24;
+}
+
+static void put_param_header(int index, uint16_t id, uint8_t dwords, uint32_t addr)
+{
+	uint8_t *p = &sfdp_image[8 + index * 8];
+
+	p[0] = id & 0xFF;
+	p[1] = 0; // minor revision
+	p[2] = 1; // major revision
+	p[3] = dwords;
+	p[4] = addr;
+	p[5] = addr >> 8;
+	p[6] = addr >> 16;
+	p[7] = id >> 8;
+}
+
+// Parameters of 32 MiB flash similar to W25Q256JV
+static void make_sfdp(int bfpt_dwords, bool fourbait)
+{
+	static const uint32_t bfpt[16] = {
+		0xFFF320E5, // 4K erase, 3- or 4-byte address, 1-1-2, 1-2-2, 1-1-4, 1-4-4
+		0x0FFFFFFF, // 256 Mbit
+		0x6B08EB44, // 1-4-4: EBh, 2 mode clocks, 4 dummy; 1-1-4: 6Bh, 8 dummy
+		0xBB423B08, // 1-1-2: 3Bh, 8 dummy; 1-2-2: BBh, 2 mode clocks, 2 dummy
+		0xFFFFFFEE, 0xFFFFFFFF, 0xFFFFFFFF,
+		0x520F200C, // 4K erase by 20h, 32K erase by 52h
+		0x0000D810, // 64K erase by D8h
+		0x00000000,
+		0x00000080, // 256 bytes page
+		0x00000000, 0x00000000, 0x00000000,
+		0x00400000, // QER = 100b
+		0x21000000, // B7h or dedicated 4-byte opcodes
+	};
+
+	memset(sfdp_image, 0xFF, sizeof(sfdp_image));
+	memcpy(sfdp_image, "SFDP", 4);
+	sfdp_image[4] = 6; // minor revision
+	sfdp_image[5] = 1; // major revision
+	sfdp_image[6] = fourbait ? 1 : 0; // number of parameter headers - 1
+	sfdp_image[7] = 0xFF;
+
+	put_param_header(0, 0xFF00, bfpt_dwords, BFPT_ADDR);
+	for (int i = 0; i < bfpt_dwords; i++)
+		put_le32(&sfdp_image[BFPT_ADDR + i * 4], bfpt[i]);
+
+	if (fourbait) {
+		put_param_header(1, 0xFF84, 2, FOURBAIT_ADDR);
+		// 13h, 0Ch, 3Ch, BCh, 6Ch, ECh, 12h and erase types 1-3
+		put_le32(&sfdp_image[FOURBAIT_ADDR], 0x00000E7F);
+		put_le32(&sfdp_image[FOURBAIT_ADDR + 4], 0x00DC5C21);
+	}
+}
+
+TEST(SfdpTests, check_params)
+{
+	sfdp_info_t info;
+
+	make_sfdp(16, true);
+	GTEST_ASSERT_EQ(sfdp_parse(nullptr, &info), -ENULL);
+	GTEST_ASSERT_EQ(sfdp_parse(sfdp_read, nullptr), -ENULL);
+
+	memset(sfdp_image, 0xFF, sizeof(sfdp_image));
+	GTEST_ASSERT_EQ(sfdp_parse(sfdp_read, &info), -ENOTSUPPORTED);
+
+	make_sfdp(8, false);
+	GTEST_ASSERT_EQ(sfdp_parse(sfdp_read, &info), -EINVALIDDATA);
+}
+
+TEST(SfdpTests, parse_bfpt_and_4bait)
+{
+	sfdp_info_t info;
+
+	make_sfdp(16, true);
+	GTEST_ASSERT_EQ(sfdp_parse(sfdp_read, &info), 0);
+
+	GTEST_ASSERT_EQ(info.size, 32 * 1024 * 1024);
+	GTEST_ASSERT_EQ(info.page_size, 256);
+	GTEST_ASSERT_EQ(info.addr4, SFDP_ADDR4_OPCODES);
+	GTEST_ASSERT_EQ(info.qe, SFDP_QE_SR2_BIT1_NO_CLR);
+	GTEST_ASSERT_EQ(info.read_opcode_4b, 0x13);
+	GTEST_ASSERT_EQ(info.program_opcode_4b, 0x12);
+
+	GTEST_ASSERT_EQ(info.read[SFDP_READ_1_4_4].opcode, 0xEB);
+	GTEST_ASSERT_EQ(info.read[SFDP_READ_1_4_4].opcode_4b, 0xEC);
+	GTEST_ASSERT_EQ(info.read[SFDP_READ_1_4_4].mode_cycles, 2);
+	GTEST_ASSERT_EQ(info.read[SFDP_READ_1_4_4].dummy_cycles, 4);
+	GTEST_ASSERT_EQ(info.read[SFDP_READ_1_1_4].opcode, 0x6B);
+	GTEST_ASSERT_EQ(info.read[SFDP_READ_1_1_4].opcode_4b, 0x6C);
+	GTEST_ASSERT_EQ(info.read[SFDP_READ_1_1_4].mode_cycles, 0);
+	GTEST_ASSERT_EQ(info.read[SFDP_READ_1_1_4].dummy_cycles, 8);
+	GTEST_ASSERT_EQ(info.read[SFDP_READ_1_2_2].opcode, 0xBB);
+	GTEST_ASSERT_EQ(info.read[SFDP_READ_1_2_2].mode_cycles, 2);
+	GTEST_ASSERT_EQ(info.read[SFDP_READ_1_2_2].dummy_cycles, 2);
+	GTEST_ASSERT_EQ(info.read[SFDP_READ_1_1_2].opcode, 0x3B);
+	GTEST_ASSERT_EQ(info.read[SFDP_READ_1_1_2].opcode_4b, 0x3C);
+
+	GTEST_ASSERT_EQ(info.erase[0].size, 4 * 1024);
+	GTEST_ASSERT_EQ(info.erase[0].opcode, 0x20);
+	GTEST_ASSERT_EQ(info.erase[0].opcode_4b, 0x21);
+	GTEST_ASSERT_EQ(info.erase[1].size, 32 * 1024);
+	GTEST_ASSERT_EQ(info.erase[1].opcode, 0x52);
+	GTEST_ASSERT_EQ(info.erase[1].opcode_4b, 0x5C);
+	GTEST_ASSERT_EQ(info.erase[2].size, 64 * 1024);
+	GTEST_ASSERT_EQ(info.erase[2].opcode, 0xD8);
+	GTEST_ASSERT_EQ(info.erase[2].opcode_4b, 0xDC);
+	GTEST_ASSERT_EQ(info.erase[3].size, 0);
+}
+
+TEST(SfdpTests, parse_jesd216_bfpt)
+{
+	sfdp_info_t info;
+
+	// The first JESD216 revision has no page size, QE and 4-byte addressing description
+	make_sfdp(9, false);
+	GTEST_ASSERT_EQ(sfdp_parse(sfdp_read, &info), 0);
+
+	GTEST_ASSERT_EQ(info.size, 32 * 1024 * 1024);
+	GTEST_ASSERT_EQ(info.page_size, 256);
+	GTEST_ASSERT_EQ(info.addr4, SFDP_ADDR4_NONE);
+	GTEST_ASSERT_EQ(info.qe, SFDP_QE_UNKNOWN);
+	GTEST_ASSERT_EQ(info.read[SFDP_READ_1_4_4].opcode, 0xEB);
+	GTEST_ASSERT_EQ(info.read[SFDP_READ_1_4_4].opcode_4b, 0);
+	GTEST_ASSERT_EQ(info.erase[2].size, 64 * 1024);
+	GTEST_ASSERT_EQ(info.erase[2].opcode_4b, 0);
+}
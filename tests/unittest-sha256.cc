@@ -0,0 +1,79 @@
+// SPDX-License-Identifier: MIT
+// Copyright 2025 RnD Center "ELVEES", JSC
+
+#include <stdint.h>
+#include <string.h>
+
+#include <gtest/gtest.h>
+#include <third-party/crypto/crypto.h>
+
+static void sha256(const void *data, int size, uint8_t *digest)
+{
+	SHA256_CTX ctx;
+
+	SHA256_Init(&ctx);
+	SHA256_Update(&ctx, (const uint8_t *)data, size);
+	SHA256_Final(digest, &ctx);
+}
+
+static void expect_digest(const uint8_t *digest, const char *hex)
+{
+	char str[2 * SHA256_SIZE + 1];
+
+	for (int i = 0; i < SHA256_SIZE; i++)
+		sprintf(&str[2 * i], "%02x", digest[i]);
+	ASSERT_STREQ(str, hex);
+}
+
+TEST(Sha256Tests, known_answers)
+{
+	const char *msg = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+	uint8_t digest[SHA256_SIZE];
+
+	// FIPS 180-2 examples
+	sha256("", 0, digest);
+	expect_digest(digest, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+	sha256("abc", 3, digest);
+	expect_digest(digest, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+	sha256(msg, strlen(msg), digest);
+	expect_digest(digest, "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+	SHA256_CTX ctx;
+	uint8_t block[1000];
+
+	memset(block, 'a', sizeof(block));
+	SHA256_Init(&ctx);
+	for (int i = 0; i < 1000; i++)
+		SHA256_Update(&ctx, block, sizeof(block));
+	SHA256_Final(digest, &ctx);
+	expect_digest(digest, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+TEST(Sha256Tests, split_and_unaligned_input)
+{
+	static uint8_t buf[4096 + 4];
+	uint8_t ref[SHA256_SIZE], digest[SHA256_SIZE];
+	uint32_t seed = 0x1234567;
+
+	for (size_t i = 0; i < sizeof(buf); i++) {
+		seed = seed * 1103515245 + 12345;
+		buf[i] = seed >> 16;
+	}
+
+	sha256(buf, 4096, ref);
+
+	// Aligned blocks are hashed in place, unaligned ones go through the context buffer
+	for (int offset = 0; offset < 4; offset++) {
+		memmove(buf + offset, buf, 4096);
+		for (int split = 0; split <= 4096; split += 61) {
+			SHA256_CTX ctx;
+
+			SHA256_Init(&ctx);
+			SHA256_Update(&ctx, buf + offset, split);
+			SHA256_Update(&ctx, buf + offset + split, 4096 - split);
+			SHA256_Final(digest, &ctx);
+			GTEST_ASSERT_EQ(memcmp(digest, ref, SHA256_SIZE), 0);
+		}
+		memmove(buf, buf + offset, 4096);
+	}
+}
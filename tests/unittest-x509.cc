@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: MIT
+// Copyright 2025 RnD Center "ELVEES", JSC
+
+#include <stdint.h>
+#include <string.h>
+
+#include <gtest/gtest.h>
+#include <third-party/crypto/crypto.h>
+#include <third-party/crypto/crypto_misc.h>
+
+#define CERT_SIG_LEN 128
+
+/**
+ * Self-signed certificate made by openssl command line tool:
+ * openssl req -x509 -newkey rsa:1024 -subj "/CN=SBL test/O=ELVEES" -sha256 -outform DER
+ */
+static const uint8_t cert[552] = {
+	0x30, 0x82, 0x02, 0x24, 0x30, 0x82, 0x01, 0x8d, 0xa0, 0x03, 0x02, 0x01, 0x02, 0x02, 0x14, 0x4e,
+	0x5e, 0x0d, 0x7b, 0x93, 0x10, 0xa1, 0x22, 0x78, 0xd6, 0xbe, 0x60, 0x6a, 0x87, 0xfe, 0x8c, 0x8a,
+	0x5b, 0xa8, 0x63, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x0b,
+	0x05, 0x00, 0x30, 0x24, 0x31, 0x11, 0x30, 0x0f, 0x06, 0x03, 0x55, 0x04, 0x03, 0x0c, 0x08, 0x53,
+	0x42, 0x4c, 0x20, 0x74, 0x65, 0x73, 0x74, 0x31, 0x0f, 0x30, 0x0d, 0x06, 0x03, 0x55, 0x04, 0x0a,
+	0x0c, 0x06, 0x45, 0x4c, 0x56, 0x45, 0x45, 0x53, 0x30, 0x1e, 0x17, 0x0d, 0x32, 0x36, 0x31, 0x30,
+	0x31, 0x36, 0x32, 0x33, 0x35, 0x31, 0x30, 0x37, 0x5a, 0x17, 0x0d, 0x33, 0x36, 0x31, 0x30, 0x31,
+	0x33, 0x32, 0x33, 0x35, 0x31, 0x30, 0x37, 0x5a, 0x30, 0x24, 0x31, 0x11, 0x30, 0x0f, 0x06, 0x03,
+	0x55, 0x04, 0x03, 0x0c, 0x08, 0x53, 0x42, 0x4c, 0x20, 0x74, 0x65, 0x73, 0x74, 0x31, 0x0f, 0x30,
+	0x0d, 0x06, 0x03, 0x55, 0x04, 0x0a, 0x0c, 0x06, 0x45, 0x4c, 0x56, 0x45, 0x45, 0x53, 0x30, 0x81,
+	0x9f, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x01, 0x05, 0x00,
+	0x03, 0x81, 0x8d, 0x00, 0x30, 0x81, 0x89, 0x02, 0x81, 0x81, 0x00, 0xc6, 0x01, 0xba, 0x17, 0x3c,
+	0x08, 0x6d, 0x55, 0xb0, 0x96, 0x45, 0x15, 0xf8, 0xb0, 0x98, 0x9b, 0xf9, 0x4a, 0x79, 0x3b, 0x8b,
+	0x3f, 0x58, 0x55, 0xa0, 0x6d, 0x31, 0x72, 0x8d, 0x3c, 0x8c, 0x63, 0x6e, 0x7a, 0x3d, 0x98, 0x45,
+	0xc8, 0xb8, 0x96, 0x4e, 0xc4, 0x47, 0xa7, 0x4b, 0x4b, 0xd4, 0xfe, 0xd9, 0x79, 0x9a, 0xb1, 0xa5,
+	0x54, 0xa9, 0x19, 0xc0, 0xbb, 0x5f, 0xed, 0xb0, 0x9c, 0x37, 0x08, 0xc2, 0x30, 0x7c, 0xdf, 0xee,
+	0xc9, 0xd7, 0x53, 0x5b, 0xc9, 0x87, 0xdb, 0x84, 0x6f, 0x58, 0x68, 0xf2, 0xdd, 0x9d, 0xa0, 0xe7,
+	0x33, 0x1e, 0x24, 0x3d, 0x14, 0x18, 0x78, 0x2f, 0x58, 0x14, 0x30, 0xf8, 0x79, 0x8f, 0xe4, 0x6c,
+	0x5a, 0x9c, 0x47, 0x7f, 0x87, 0x98, 0xa0, 0x8e, 0x3e, 0x4e, 0x52, 0xe7, 0xc0, 0xfe, 0xf4, 0xeb,
+	0x72, 0x53, 0x38, 0x17, 0x3e, 0xcc, 0x21, 0x37, 0x0f, 0x12, 0x91, 0x02, 0x03, 0x01, 0x00, 0x01,
+	0xa3, 0x53, 0x30, 0x51, 0x30, 0x1d, 0x06, 0x03, 0x55, 0x1d, 0x0e, 0x04, 0x16, 0x04, 0x14, 0xaa,
+	0x32, 0xc6, 0xd9, 0x9e, 0xfb, 0x59, 0x83, 0x9e, 0x4f, 0xd8, 0xd7, 0x0a, 0x0d, 0xea, 0x3f, 0x98,
+	0x00, 0xa4, 0xf1, 0x30, 0x1f, 0x06, 0x03, 0x55, 0x1d, 0x23, 0x04, 0x18, 0x30, 0x16, 0x80, 0x14,
+	0xaa, 0x32, 0xc6, 0xd9, 0x9e, 0xfb, 0x59, 0x83, 0x9e, 0x4f, 0xd8, 0xd7, 0x0a, 0x0d, 0xea, 0x3f,
+	0x98, 0x00, 0xa4, 0xf1, 0x30, 0x0f, 0x06, 0x03, 0x55, 0x1d, 0x13, 0x01, 0x01, 0xff, 0x04, 0x05,
+	0x30, 0x03, 0x01, 0x01, 0xff, 0x30, 0x0d, 0x06, 0x09, 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01,
+	0x01, 0x0b, 0x05, 0x00, 0x03, 0x81, 0x81, 0x00, 0x40, 0x9c, 0xf1, 0xf1, 0x13, 0xa5, 0x6b, 0xcd,
+	0x38, 0xd3, 0xdb, 0x20, 0x66, 0xef, 0x0a, 0xed, 0x1f, 0x13, 0x0a, 0xe6, 0x6c, 0xe9, 0x53, 0xbb,
+	0x5f, 0x54, 0x31, 0xac, 0x83, 0x44, 0xbe, 0x3a, 0x39, 0x53, 0xf3, 0xe1, 0x2b, 0xd8, 0xb3, 0xc5,
+	0xdc, 0xda, 0x4c, 0x44, 0xc1, 0xd0, 0x10, 0x95, 0xe0, 0xc4, 0x3a, 0x57, 0x17, 0xf8, 0x0e, 0x5c,
+	0x48, 0x28, 0x6b, 0x72, 0xfe, 0x9f, 0x03, 0x18, 0x16, 0xfc, 0xd0, 0xf7, 0xd2, 0x94, 0xb6, 0x75,
+	0x19, 0xa8, 0x21, 0xe4, 0x70, 0x33, 0xe7, 0x68, 0xa5, 0x26, 0x43, 0x2f, 0x29, 0xdb, 0xe8, 0xaf,
+	0x9c, 0x59, 0x01, 0xf4, 0x61, 0xe2, 0xee, 0xf9, 0x2b, 0xaf, 0x29, 0x32, 0x1a, 0xd4, 0xd8, 0xcf,
+	0xff, 0x5d, 0xa9, 0x14, 0x6f, 0x35, 0xb6, 0x54, 0x8e, 0x5c, 0xcb, 0x94, 0x95, 0xbf, 0x54, 0x31,
+	0x5d, 0xc9, 0x9c, 0xc4, 0xdd, 0x5e, 0xa3, 0x35,
+};
+
+// Subject fields and the signature point into the certificate, nothing is copied
+TEST(X509Tests, fields_point_into_der)
+{
+	X509_CTX *x509 = NULL;
+	int len = 0;
+
+	bi_arena_reset();
+	ASSERT_EQ(x509_new(cert, &len, &x509), X509_OK);
+	ASSERT_NE(x509, nullptr);
+	EXPECT_EQ(len, (int)sizeof(cert));
+
+	EXPECT_EQ(x509->sig_len, CERT_SIG_LEN);
+	EXPECT_EQ(x509->signature, cert + sizeof(cert) - CERT_SIG_LEN);
+
+	const x509_dn_t *cn = &x509->cert_dn[X509_COMMON_NAME];
+	ASSERT_EQ(cn->len, 8);
+	EXPECT_TRUE(cn->str > cert && cn->str < cert + sizeof(cert));
+	EXPECT_EQ(memcmp(cn->str, "SBL test", cn->len), 0);
+	EXPECT_EQ(x509->cert_dn[X509_LOCATION].str, nullptr);
+
+	EXPECT_EQ(asn1_compare_dn(x509->ca_cert_dn, x509->cert_dn), 0);
+
+	x509_free(x509);
+	bi_arena_reset();
+}
+
+// BMPString matches other string types by the low bytes of its characters
+TEST(X509Tests, dn_compare_bmp_string)
+{
+	static const uint8_t bmp[] = { 0, 'E', 0, 'L', 0, 'V', 0, 'E', 0, 'E', 0, 'S' };
+	static const uint8_t bad[] = { 0, 'E', 0, 'L', 0, 'V', 0, 'E', 0, 'E', 0, 'Z' };
+	static const uint8_t str[] = { 'E', 'L', 'V', 'E', 'E', 'S' };
+	x509_dn_t dn1[X509_NUM_DN_TYPES] = {};
+	x509_dn_t dn2[X509_NUM_DN_TYPES] = {};
+
+	dn1[X509_ORGANIZATION] = { str, sizeof(str), ASN1_PRINTABLE_STR };
+	dn2[X509_ORGANIZATION] = { bmp, sizeof(bmp), ASN1_UNICODE_STR };
+	EXPECT_EQ(asn1_compare_dn(dn1, dn2), 0);
+	EXPECT_EQ(asn1_compare_dn(dn2, dn1), 0);
+
+	dn2[X509_ORGANIZATION] = { bad, sizeof(bad), ASN1_UNICODE_STR };
+	EXPECT_NE(asn1_compare_dn(dn1, dn2), 0);
+
+	dn2[X509_ORGANIZATION] = { str, sizeof(str) - 1, ASN1_PRINTABLE_STR };
+	EXPECT_NE(asn1_compare_dn(dn1, dn2), 0);
+
+	dn2[X509_ORGANIZATION] = {};
+	EXPECT_NE(asn1_compare_dn(dn1, dn2), 0);
+}
+
+// Contexts of the root and CONFIG_X509_MAX_CA_CERTS certificates are taken from the static pool
+TEST(X509Tests, context_pool)
+{
+	X509_CTX *x509[CONFIG_X509_MAX_CA_CERTS + 1] = {};
+	X509_CTX *extra = NULL;
+
+	bi_arena_reset();
+	for (auto &ctx : x509)
+		ASSERT_EQ(x509_new(cert, NULL, &ctx), X509_OK);
+
+	EXPECT_EQ(x509_new(cert, NULL, &extra), X509_MALLOC_ERROR);
+	EXPECT_EQ(extra, nullptr);
+
+	x509_free(x509[0]);
+	EXPECT_EQ(x509_new(cert, NULL, &x509[0]), X509_OK);
+	EXPECT_NE(x509[0], nullptr);
+
+	for (auto &ctx : x509)
+		x509_free(ctx);
+	bi_arena_reset();
+}
@@ -147,6 +147,10 @@ static uint8_t getSBoxInvert(uint8_t num)
 */
 #define getSBoxInvert(num) (rsbox[(num)])
 
+#if defined(AES_TTABLE_ENABLE) && ((defined(CBC) && CBC == 1) || (defined(ECB) && ECB == 1))
+static void InvTableKeyExpansion(struct AES_ctx* ctx);
+#endif
+
 // This function produces Nb(Nr+1) round keys. The round keys are used in each round to decrypt the states. 
 static void KeyExpansion(uint8_t* RoundKey, const uint8_t* Key)
 {
@@ -224,11 +228,14 @@ static void KeyExpansion(uint8_t* RoundKey, const uint8_t* Key)
 void AES_init_ctx(struct AES_ctx* ctx, const uint8_t* key)
 {
   KeyExpansion(ctx->RoundKey, key);
+#if defined(AES_TTABLE_ENABLE) && ((defined(CBC) && CBC == 1) || (defined(ECB) && ECB == 1))
+  InvTableKeyExpansion(ctx);
+#endif
 }
 #if (defined(CBC) && (CBC == 1)) || (defined(CTR) && (CTR == 1))
 void AES_init_ctx_iv(struct AES_ctx* ctx, const uint8_t* key, const uint8_t* iv)
 {
-  KeyExpansion(ctx->RoundKey, key);
+  AES_init_ctx(ctx, key);
   memcpy (ctx->Iv, iv, AES_BLOCKLEN);
 }
 void AES_ctx_set_iv(struct AES_ctx* ctx, const uint8_t* iv)
@@ -341,6 +348,7 @@ static uint8_t Multiply(uint8_t x, uint8_t y)
 #endif
 
 #if (defined(CBC) && CBC == 1) || (defined(ECB) && ECB == 1)
+#ifndef AES_TTABLE_ENABLE
 // MixColumns function mixes the columns of the state matrix.
 // The method used to multiply may be difficult to understand for the inexperienced.
 // Please use the references to gain more information.
@@ -404,6 +412,109 @@ static void InvShiftRows(state_t* state)
   (*state)[2][3] = (*state)[3][3];
   (*state)[3][3] = temp;
 }
+
+#else
+// 32-bit lookup table inverse cipher. A state column is a big-endian word, Td[0][x] is
+// InvMixColumns of the column (InvSbox[x], 0, 0, 0) and Td[1..3] are its byte rotations,
+// so a round is 16 lookups and XORs. Tables are built once from rsbox.
+#define GETU32(p) (((uint32_t)(p)[0] << 24) | ((uint32_t)(p)[1] << 16) | \
+                   ((uint32_t)(p)[2] << 8) | ((uint32_t)(p)[3]))
+
+#define PUTU32(p, v)              \
+  {                               \
+    (p)[0] = (uint8_t)((v) >> 24); \
+    (p)[1] = (uint8_t)((v) >> 16); \
+    (p)[2] = (uint8_t)((v) >> 8);  \
+    (p)[3] = (uint8_t)(v);         \
+  }
+
+static uint32_t Td[4][256];
+static uint8_t TdReady;
+
+static void InvTablesInit(void)
+{
+  unsigned i;
+
+  if (TdReady)
+    return;
+
+  for (i = 0; i < 256; ++i)
+  {
+    uint8_t s = getSBoxInvert(i);
+    uint32_t w = ((uint32_t)Multiply(s, 0x0e) << 24) | ((uint32_t)Multiply(s, 0x09) << 16) |
+                 ((uint32_t)Multiply(s, 0x0d) << 8) | (uint32_t)Multiply(s, 0x0b);
+
+    Td[0][i] = w;
+    Td[1][i] = (w >> 8) | (w << 24);
+    Td[2][i] = (w >> 16) | (w << 16);
+    Td[3][i] = (w >> 24) | (w << 8);
+  }
+  TdReady = 1;
+}
+
+// Round keys of the equivalent inverse cipher in the order of use: the last round key first,
+// InvMixColumns applied to all but the first and the last ones.
+static void InvTableKeyExpansion(struct AES_ctx* ctx)
+{
+  unsigned round, i;
+
+  InvTablesInit();
+  for (round = 0; round <= Nr; ++round)
+  {
+    for (i = 0; i < Nb; ++i)
+    {
+      const uint8_t* k = &ctx->RoundKey[((Nr - round) * Nb + i) * 4];
+
+      if (round == 0 || round == Nr)
+        ctx->DecRoundKey[round * Nb + i] = GETU32(k);
+      else
+        ctx->DecRoundKey[round * Nb + i] =
+          Td[0][getSBoxValue(k[0])] ^ Td[1][getSBoxValue(k[1])] ^
+          Td[2][getSBoxValue(k[2])] ^ Td[3][getSBoxValue(k[3])];
+    }
+  }
+}
+
+#define TD_COLUMN(a, b, c, d, k)                                  \
+  (Td[0][(a) >> 24] ^ Td[1][((b) >> 16) & 0xff] ^                  \
+   Td[2][((c) >> 8) & 0xff] ^ Td[3][(d) & 0xff] ^ (k))
+
+#define RSBOX_COLUMN(a, b, c, d, k)                                                   \
+  ((((uint32_t)getSBoxInvert((a) >> 24) << 24) |                                       \
+    ((uint32_t)getSBoxInvert(((b) >> 16) & 0xff) << 16) |                              \
+    ((uint32_t)getSBoxInvert(((c) >> 8) & 0xff) << 8) |                                \
+    (uint32_t)getSBoxInvert((d) & 0xff)) ^ (k))
+
+static void InvCipherTable(uint32_t* s, const uint32_t* rk)
+{
+  uint32_t s0, s1, s2, s3, t0, t1, t2, t3;
+  uint8_t round;
+
+  s0 = s[0] ^ rk[0];
+  s1 = s[1] ^ rk[1];
+  s2 = s[2] ^ rk[2];
+  s3 = s[3] ^ rk[3];
+
+  for (round = 1; round < Nr; ++round)
+  {
+    rk += Nb;
+    t0 = TD_COLUMN(s0, s3, s2, s1, rk[0]);
+    t1 = TD_COLUMN(s1, s0, s3, s2, rk[1]);
+    t2 = TD_COLUMN(s2, s1, s0, s3, rk[2]);
+    t3 = TD_COLUMN(s3, s2, s1, s0, rk[3]);
+    s0 = t0;
+    s1 = t1;
+    s2 = t2;
+    s3 = t3;
+  }
+
+  rk += Nb;
+  s[0] = RSBOX_COLUMN(s0, s3, s2, s1, rk[0]);
+  s[1] = RSBOX_COLUMN(s1, s0, s3, s2, rk[1]);
+  s[2] = RSBOX_COLUMN(s2, s1, s0, s3, rk[2]);
+  s[3] = RSBOX_COLUMN(s3, s2, s1, s0, rk[3]);
+}
+#endif // #ifndef AES_TTABLE_ENABLE
 #endif // #if (defined(CBC) && CBC == 1) || (defined(ECB) && ECB == 1)
 
 // Cipher is the main function that encrypts the PlainText.
@@ -432,7 +543,7 @@ static void Cipher(state_t* state, const uint8_t* RoundKey)
   AddRoundKey(Nr, state, RoundKey);
 }
 
-#if (defined(CBC) && CBC == 1) || (defined(ECB) && ECB == 1)
+#if ((defined(CBC) && CBC == 1) || (defined(ECB) && ECB == 1)) && !defined(AES_TTABLE_ENABLE)
 static void InvCipher(state_t* state, const uint8_t* RoundKey)
 {
   uint8_t round = 0;
@@ -473,8 +584,19 @@ void AES_ECB_encrypt(const struct AES_ctx* ctx, uint8_t* buf)
 
 void AES_ECB_decrypt(const struct AES_ctx* ctx, uint8_t* buf)
 {
+#ifdef AES_TTABLE_ENABLE
+  uint32_t s[4];
+  uint8_t i;
+
+  for (i = 0; i < 4; ++i)
+    s[i] = GETU32(buf + i * 4);
+  InvCipherTable(s, ctx->DecRoundKey);
+  for (i = 0; i < 4; ++i)
+    PUTU32(buf + i * 4, s[i]);
+#else
   // The next function call decrypts the PlainText with the Key using AES algorithm.
   InvCipher((state_t*)buf, ctx->RoundKey);
+#endif
 }
 
 void AES_ECB_encrypt_wrap(const uint8_t *input, const uint8_t *key, uint8_t *output,
@@ -532,6 +654,30 @@ void AES_CBC_encrypt_buffer(struct AES_ctx *ctx, uint8_t* buf, uint32_t length)
 void AES_CBC_decrypt_buffer(struct AES_ctx* ctx, uint8_t* buf,  uint32_t length)
 {
   uintptr_t i;
+#ifdef AES_TTABLE_ENABLE
+  // IV and ciphertext are kept as words, the block is deciphered in registers
+  uint32_t iv[4], c[4], s[4];
+  uint8_t j;
+
+  for (j = 0; j < 4; ++j)
+    iv[j] = GETU32(ctx->Iv + j * 4);
+
+  for (i = 0; i < length; i += AES_BLOCKLEN)
+  {
+    for (j = 0; j < 4; ++j)
+      s[j] = c[j] = GETU32(buf + j * 4);
+    InvCipherTable(s, ctx->DecRoundKey);
+    for (j = 0; j < 4; ++j)
+    {
+      PUTU32(buf + j * 4, s[j] ^ iv[j]);
+      iv[j] = c[j];
+    }
+    buf += AES_BLOCKLEN;
+  }
+
+  for (j = 0; j < 4; ++j)
+    PUTU32(ctx->Iv + j * 4, iv[j]);
+#else
   uint8_t storeNextIv[AES_BLOCKLEN];
   for (i = 0; i < length; i += AES_BLOCKLEN)
   {
@@ -541,6 +687,7 @@ void AES_CBC_decrypt_buffer(struct AES_ctx* ctx, uint8_t* buf,  uint32_t length)
     memcpy(ctx->Iv, storeNextIv, AES_BLOCKLEN);
     buf += AES_BLOCKLEN;
   }
+#endif
 
 }
 
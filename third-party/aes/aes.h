@@ -3,6 +3,10 @@
 
 #include <stdint.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 // #define the macros below to 1/0 to enable/disable the mode of operation.
 //
 // CBC enables AES encryption in CBC-mode of operation.
@@ -22,6 +26,9 @@
   #define CTR 1
 #endif
 
+// AES_TTABLE_ENABLE selects the 32-bit lookup table inverse cipher for CBC/ECB decryption.
+// It takes 4 KiB of RAM for the tables and a decryption key schedule in AES_ctx.
+
 
 #define AES128 1
 //#define AES192 1
@@ -43,6 +50,9 @@
 struct AES_ctx
 {
   uint8_t RoundKey[AES_keyExpSize];
+#ifdef AES_TTABLE_ENABLE
+  uint32_t DecRoundKey[AES_keyExpSize / 4];
+#endif
 #if (defined(CBC) && (CBC == 1)) || (defined(CTR) && (CTR == 1))
   uint8_t Iv[AES_BLOCKLEN];
 #endif
@@ -96,5 +106,8 @@ void AES_CTR_xcrypt_buffer(struct AES_ctx* ctx, uint8_t* buf, uint32_t length);
 
 #endif // #if defined(CTR) && (CTR == 1)
 
+#ifdef __cplusplus
+}
+#endif
 
 #endif //_AES_H_
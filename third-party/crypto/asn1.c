@@ -176,6 +176,32 @@ end_big_int:
     return len;
 }
 
+#ifdef CONFIG_X509_ZERO_COPY
+/**
+ * Read an integer value for ASN.1 data, the object points into the buffer.
+ */
+static int asn1_get_big_int_ptr(const uint8_t *buf, int *offset,
+        const uint8_t **object)
+{
+    int len;
+
+    if ((len = asn1_next_obj(buf, offset, ASN1_INTEGER)) < 0)
+        goto end_big_int;
+
+    if (len > 1 && buf[*offset] == 0x00)    /* ignore the negative byte */
+    {
+        len--;
+        (*offset)++;
+    }
+
+    *object = &buf[*offset];
+    *offset += len;
+
+end_big_int:
+    return len;
+}
+#endif
+
 /**
  * Read an integer value for ASN.1 data
  */
@@ -383,10 +409,18 @@ end_oid:
     return dn_type;
 }
 
+#ifdef CONFIG_X509_ZERO_COPY
+#define DN_IS_SET(dn)   ((dn).str != NULL)
+#define DN_FREE(dn)
+#else
+#define DN_IS_SET(dn)   ((dn) != NULL)
+#define DN_FREE(dn)     free(dn)
+#endif
+
 /**
  * Obtain an ASN.1 printable string type.
  */
-static int asn1_get_printable_str(const uint8_t *buf, int *offset, char **str)
+static int asn1_get_printable_str(const uint8_t *buf, int *offset, x509_dn_t *str)
 {
     int len = X509_NOT_OK;
     int asn1_type = buf[*offset];
@@ -402,6 +436,12 @@ static int asn1_get_printable_str(const uint8_t *buf, int *offset, char **str)
     (*offset)++;
     len = get_asn1_length(buf, offset);
 
+#ifdef CONFIG_X509_ZERO_COPY
+    /* the string is used in place, BMPString is reduced on comparison */
+    str->str = &buf[*offset];
+    str->len = len;
+    str->type = asn1_type;
+#else
     if (asn1_type == ASN1_UNICODE_STR)
     {
         int i;
@@ -422,6 +462,7 @@ static int asn1_get_printable_str(const uint8_t *buf, int *offset, char **str)
         memcpy(*str, &buf[*offset], len);
         (*str)[len] = 0;                    /* null terminate */
     }
+#endif
 
     *offset += len;
 
@@ -432,11 +473,11 @@ end_pnt_str:
 /**
  * Get the subject name (or the issuer) of a certificate.
  */
-int asn1_name(const uint8_t *cert, int *offset, char *dn[])
+int asn1_name(const uint8_t *cert, int *offset, x509_dn_t dn[])
 {
     int ret = X509_NOT_OK;
     int dn_type;
-    char *tmp;
+    x509_dn_t tmp;
 
     if (asn1_next_obj(cert, offset, ASN1_SEQUENCE) < 0)
         goto end_name;
@@ -449,14 +490,14 @@ int asn1_name(const uint8_t *cert, int *offset, char *dn[])
                (dn_type = asn1_get_oid_x520(cert, offset)) < 0)
             goto end_name;
 
-        tmp = NULL;
+        memset(&tmp, 0, sizeof(tmp));
 
         int p_str_res = asn1_get_printable_str(cert, offset, &tmp);
         if (p_str_res < 0)
         {
             if (p_str_res == X509_MALLOC_ERROR)
                 ret = X509_MALLOC_ERROR;
-            free(tmp);
+            DN_FREE(tmp);
             goto end_name;
         }
 
@@ -465,7 +506,7 @@ int asn1_name(const uint8_t *cert, int *offset, char *dn[])
         {
             if (dn_type == g_dn_types[i])
             {
-                if (dn[i] == NULL)
+                if (!DN_IS_SET(dn[i]))
                 {
                     dn[i] = tmp;
                     found = 1;
@@ -476,7 +517,7 @@ int asn1_name(const uint8_t *cert, int *offset, char *dn[])
 
         if (found == 0) /* not found so get rid of it */
         {
-            free(tmp);
+            DN_FREE(tmp);
         }
     }
 
@@ -491,7 +532,11 @@ end_name:
 int asn1_public_key(const uint8_t *cert, int *offset, X509_CTX *x509_ctx)
 {
     int ret = X509_NOT_OK, mod_len, pub_len;
+#ifdef CONFIG_X509_ZERO_COPY
+    const uint8_t *modulus = NULL, *pub_exp = NULL;
+#else
     uint8_t *modulus = NULL, *pub_exp = NULL;
+#endif
 
     if (asn1_next_obj(cert, offset, ASN1_SEQUENCE) < 0 ||
             asn1_skip_obj(cert, offset, ASN1_SEQUENCE) ||
@@ -503,18 +548,29 @@ int asn1_public_key(const uint8_t *cert, int *offset, X509_CTX *x509_ctx)
     if (asn1_next_obj(cert, offset, ASN1_SEQUENCE) < 0)
         goto end_pub_key;
 
+#ifdef CONFIG_X509_ZERO_COPY
+    mod_len = asn1_get_big_int_ptr(cert, offset, &modulus);
+    if (mod_len < 0)
+        return mod_len;
+    pub_len = asn1_get_big_int_ptr(cert, offset, &pub_exp);
+    if (pub_len < 0)
+        return pub_len;
+#else
     mod_len = asn1_get_big_int(cert, offset, &modulus);
     if (mod_len < 0)
         return mod_len;
     pub_len = asn1_get_big_int(cert, offset, &pub_exp);
     if (pub_len < 0)
         return pub_len;
+#endif
 
     if (RSA_pub_key_new(&x509_ctx->rsa_ctx, modulus, mod_len, pub_exp, pub_len) != 0)
         return X509_MALLOC_ERROR;
 
+#ifndef CONFIG_X509_ZERO_COPY
     free(modulus);
     free(pub_exp);
+#endif
     ret = X509_OK;
 
 end_pub_key:
@@ -534,10 +590,14 @@ int asn1_signature(const uint8_t *cert, int *offset, X509_CTX *x509_ctx)
 
     x509_ctx->sig_len = get_asn1_length(cert, offset)-1;
     (*offset)++;            /* ignore bit string padding bits */
+#ifdef CONFIG_X509_ZERO_COPY
+    x509_ctx->signature = &cert[*offset];
+#else
     x509_ctx->signature = (uint8_t *)malloc(x509_ctx->sig_len);
     if (x509_ctx->signature == NULL)
         return X509_MALLOC_ERROR;
     memcpy(x509_ctx->signature, &cert[*offset], x509_ctx->sig_len);
+#endif
     *offset += x509_ctx->sig_len;
     ret = X509_OK;
 
@@ -549,6 +609,30 @@ end_sig:
  * Compare 2 distinguished name components for equality 
  * @return 0 if a match
  */
+#ifdef CONFIG_X509_ZERO_COPY
+static int asn1_compare_dn_comp(const x509_dn_t *dn1, const x509_dn_t *dn2)
+{
+    /* only the low bytes of BMPString characters are compared, as if it
+       were copied */
+    int step1 = (dn1->type == ASN1_UNICODE_STR) ? 2 : 1;
+    int step2 = (dn2->type == ASN1_UNICODE_STR) ? 2 : 1;
+    int i, len = dn1->len / step1;
+
+    if (dn1->str == NULL || dn2->str == NULL)
+        return dn1->str != dn2->str;
+
+    if (len != dn2->len / step2)
+        return 1;
+
+    for (i = 0; i < len; i++)
+    {
+        if (dn1->str[i*step1 + step1 - 1] != dn2->str[i*step2 + step2 - 1])
+            return 1;
+    }
+
+    return 0;
+}
+#else
 static int asn1_compare_dn_comp(const char *dn1, const char *dn2)
 {
     int ret;
@@ -560,6 +644,7 @@ static int asn1_compare_dn_comp(const char *dn1, const char *dn2)
 
     return ret;
 }
+#endif
 
 /**
  * Clean up all of the CA certificates.
@@ -584,13 +669,17 @@ void remove_ca_certs(CA_CERT_CTX *ca_cert_ctx)
  * Compare 2 distinguished names for equality 
  * @return 0 if a match
  */
-int asn1_compare_dn(char * const dn1[], char * const dn2[])
+int asn1_compare_dn(const x509_dn_t dn1[], const x509_dn_t dn2[])
 {
     int i;
 
     for (i = 0; i < X509_NUM_DN_TYPES; i++)
     {
+#ifdef CONFIG_X509_ZERO_COPY
+        if (asn1_compare_dn_comp(&dn1[i], &dn2[i]))
+#else
         if (asn1_compare_dn_comp(dn1[i], dn2[i]))
+#endif
             return 1;
     }
 
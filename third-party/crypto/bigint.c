@@ -84,6 +84,29 @@ static bigint *comp_right_shift(bigint *biR, int num_shifts);
 static bigint *comp_left_shift(bigint *biR, int num_shifts);
 #endif
 
+#ifdef CONFIG_BIGINT_ARENA
+/* Components of the largest intermediate: a product of two numbers of the
+ * modulus size plus spare components for Barrett reduction and division. */
+#define ARENA_COMPS     (2*(CONFIG_BIGINT_ARENA_MOD_BYTES/COMP_BYTE_SIZE) + 4)
+
+/* Every key keeps its radix, modulus, exponent, mu, normalised modulus and
+ * a digest permanent, a verification needs a few more temporaries. */
+#define ARENA_KEY_SLOTS     6
+#define ARENA_TEMP_SLOTS    12
+#define ARENA_SLOTS     ((CONFIG_X509_MAX_CA_CERTS + 1)*ARENA_KEY_SLOTS + \
+                            ARENA_TEMP_SLOTS)
+
+typedef struct
+{
+    bigint bi;
+    comp comps[ARENA_COMPS];
+} arena_slot;
+
+static arena_slot arena[ARENA_SLOTS];
+static bigint *arena_free_list;     /**< Released slots. */
+static int arena_used;              /**< Slots taken from the arena so far. */
+#endif
+
 #ifdef CONFIG_BIGINT_CHECK_ON
 static void check(const bigint *bi);
 #else
@@ -105,7 +128,10 @@ BI_CTX *bi_initialize(void)
     /* the radix */
     ctx->bi_radix = alloc(ctx, 2); 
     if (ctx->bi_radix == NULL)
+    {
+        free(ctx);
         return NULL;
+    }
     ctx->bi_radix->comps[0] = 0;
     ctx->bi_radix->comps[1] = 1;
     bi_permanent(ctx->bi_radix);
@@ -137,8 +163,23 @@ void bi_terminate(BI_CTX *ctx)
     free(ctx);
 }
 
+#ifdef CONFIG_BIGINT_ARENA
+/**
+ * @brief Give all arena slots back at once.
+ *
+ * Only valid when every bigint context has been terminated.
+ */
+void bi_arena_reset(void)
+{
+    arena_free_list = NULL;
+    arena_used = 0;
+}
+#endif
+
 /**
  *@brief Clear the memory cache.
+ *
+ * With CONFIG_BIGINT_ARENA the cached bigints are given back to the arena.
  */
 void bi_clear_cache(BI_CTX *ctx)
 {
@@ -150,8 +191,13 @@ void bi_clear_cache(BI_CTX *ctx)
     for (p = ctx->free_list; p != NULL; p = pn)
     {
         pn = p->next;
+#ifdef CONFIG_BIGINT_ARENA
+        p->next = arena_free_list;
+        arena_free_list = p;
+#else
         free(p->comps);
         free(p);
+#endif
     }
 
     ctx->free_count = 0;
@@ -661,7 +707,7 @@ bigint *bi_import(BI_CTX *ctx, const uint8_t *data, int size)
 
     for (i = size-1; i >= 0; i--)
     {
-        biR->comps[offset] += data[i] << (j*8);
+        biR->comps[offset] += (comp)data[i] << (j*8);
 
         if (++j == COMP_BYTE_SIZE)
         {
@@ -753,7 +799,7 @@ void bi_export(BI_CTX *ctx, bigint *x, uint8_t *data, int size)
     {
         for (j = 0; j < COMP_BYTE_SIZE; j++)
         {
-            comp mask = 0xff << (j*8);
+            comp mask = (comp)0xff << (j*8);
             int num = (x->comps[i] & mask) >> (j*8);
             data[k--] = num;
 
@@ -901,9 +947,8 @@ static bigint *regular_multiply(BI_CTX *ctx, bigint *bia, bigint *bib,
 
     do 
     {
-        long_comp tmp;
-        comp carry = 0;
         int r_index = i;
+        int len;
         j = 0;
 
         if (outer_partial && outer_partial-i > 0 && outer_partial < n)
@@ -912,19 +957,15 @@ static bigint *regular_multiply(BI_CTX *ctx, bigint *bia, bigint *bib,
             j = outer_partial-i-1;
         }
 
-        do
-        {
-            if (inner_partial && r_index >= inner_partial) 
-            {
-                break;
-            }
+        len = n - j;
 
-            tmp = sr[r_index] + ((long_comp)sa[j])*sb[i] + carry;
-            sr[r_index++] = (comp)tmp;              /* downsize */
-            carry = tmp >> COMP_BIT_SIZE;
-        } while (++j < n);
+        /* only the lower inner_partial components are needed */
+        if (inner_partial && r_index + len > inner_partial)
+        {
+            len = max(inner_partial - r_index, 0);
+        }
 
-        sr[r_index] = carry;
+        sr[r_index + len] = bi_mul_add_row(&sr[r_index], &sa[j], len, sb[i]);
     } while (++i < t);
 
     bi_free(ctx, bia);
@@ -932,6 +973,23 @@ static bigint *regular_multiply(BI_CTX *ctx, bigint *bia, bigint *bib,
     return trim(biR);
 }
 
+#ifndef CONFIG_BIGINT_MIPS32_ASM
+comp bi_mul_add_row(comp *r, const comp *a, int n, comp b)
+{
+    comp carry = 0;
+    int j;
+
+    for (j = 0; j < n; j++)
+    {
+        long_comp tmp = r[j] + ((long_comp)a[j])*b + carry;
+        r[j] = (comp)tmp;                       /* downsize */
+        carry = tmp >> COMP_BIT_SIZE;
+    }
+
+    return carry;
+}
+#endif
+
 #ifdef CONFIG_BIGINT_KARATSUBA
 /*
  * Karatsuba improves on regular multiplication due to only 3 multiplications 
@@ -1199,6 +1257,10 @@ static int more_comps(bigint *bi, int n)
 {
     if (n > bi->max_comps)
     {
+#ifdef CONFIG_BIGINT_ARENA
+        /* arena slots have a fixed size */
+        return -1;
+#endif
         bi->max_comps = max(bi->max_comps * 2, n);
         bi->comps = (comp*)realloc(bi->comps, bi->max_comps * COMP_BYTE_SIZE);
         if (bi->comps == NULL)
@@ -1223,6 +1285,12 @@ static bigint *alloc(BI_CTX *ctx, int size)
 {
     bigint *biR;
 
+#ifdef CONFIG_BIGINT_ARENA
+    /* all arena slots have the same size */
+    if (size > ARENA_COMPS)
+        return NULL;
+#endif
+
     /* Can we recycle an old bigint? */
     if (ctx->free_list != NULL)
     {
@@ -1243,6 +1311,21 @@ static bigint *alloc(BI_CTX *ctx, int size)
     }
     else
     {
+#ifdef CONFIG_BIGINT_ARENA
+        /* No free bigints available - take one from the arena. */
+        if (arena_free_list != NULL)
+        {
+            biR = arena_free_list;
+            arena_free_list = biR->next;
+        }
+        else if (arena_used < ARENA_SLOTS)
+            biR = &arena[arena_used++].bi;
+        else
+            return NULL;
+
+        biR->comps = ((arena_slot *)biR)->comps;
+        biR->max_comps = ARENA_COMPS;
+#else
         /* No free bigints available - create a new one. */
         biR = (bigint *)malloc(sizeof(bigint));
         if (biR == NULL)
@@ -1253,6 +1336,7 @@ static bigint *alloc(BI_CTX *ctx, int size)
             return NULL;
 
         biR->max_comps = size; /* give some space to spare */
+#endif
     }
 
     biR->size = size;
@@ -1571,10 +1655,8 @@ bigint *bi_mod_power(BI_CTX *ctx, bigint *bi, bigint *biexp)
     if (precompute_slide_window(ctx, window_size, bi) != 0)
         return NULL;
 
-#else   /* just one constant */
-    ctx->g = (bigint **)malloc(sizeof(bigint *));
-    if (ctx->g == NULL)
-        return NULL;
+#else   /* just one constant, kept in the context */
+    ctx->g = &ctx->g0;
 
     ctx->g[0] = bi_clone(ctx, bi);
     if (ctx->g[0] == NULL)
@@ -1651,7 +1733,9 @@ bigint *bi_mod_power(BI_CTX *ctx, bigint *bi, bigint *biexp)
         bi_free(ctx, ctx->g[i]);
     }
 
+#ifdef CONFIG_BIGINT_SLIDING_WINDOW
     free(ctx->g);
+#endif
     bi_free(ctx, bi);
     bi_free(ctx, biexp);
 #if defined CONFIG_BIGINT_MONTGOMERY
@@ -113,6 +113,9 @@ typedef struct /**< A big integer "session" context. */
 #endif
     bigint *bi_normalised_mod[BIGINT_NUM_MODS]; /**< Normalised mod storage. */
     bigint **g;                 /**< Used by sliding-window. */
+#ifndef CONFIG_BIGINT_SLIDING_WINDOW
+    bigint *g0;                 /**< The only constant without sliding-window. */
+#endif
     int window;                 /**< The size of the sliding window */
     int active_count;           /**< Number of active bigints. */
     int free_count;             /**< Number of free bigints. */
@@ -130,4 +133,14 @@ typedef struct /**< A big integer "session" context. */
 
 #define PERMANENT           0x7FFF55AA  /**< A magic number for permanents. */
 
+/**
+ * @brief Multiply-accumulate one row: r[0..n-1] += a[0..n-1] * b.
+ *
+ * It is the inner loop of multiplication and Barrett reduction. With
+ * CONFIG_BIGINT_MIPS32_ASM it is implemented in bigint_mips32.S, otherwise
+ * the portable C version from bigint.c is used.
+ * @return The carry out of r[n-1].
+ */
+comp bi_mul_add_row(comp *r, const comp *a, int n, comp b);
+
 #endif
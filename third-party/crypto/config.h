@@ -6,3 +6,27 @@
 #define CONFIG_SSL_CERT_VERIFICATION
 #define CONFIG_BIGINT_BARRETT
 #define CONFIG_X509_MAX_CA_CERTS 7
+
+// Certificate contexts are taken from a static pool, distinguished names and the signature point
+// into the DER buffer instead of being copied, so it must outlive the context. Subject
+// alternative DNS names are not collected.
+#define CONFIG_X509_ZERO_COPY
+
+#if defined(CONFIG_X509_ZERO_COPY) && defined(CONFIG_SSL_FULL_MODE)
+#error "CONFIG_X509_ZERO_COPY doesn't support printing of certificates"
+#endif
+
+// Bigints are taken from a static arena instead of the heap. Arena slots hold intermediates of
+// a modulus up to CONFIG_BIGINT_ARENA_MOD_BYTES long, larger keys are rejected.
+#define CONFIG_BIGINT_ARENA
+#define CONFIG_BIGINT_ARENA_MOD_BYTES 384
+
+// Inner multiply-accumulate loop of bigint multiplication is implemented in bigint_mips32.S
+#if defined(__mips__) && !defined(CONFIG_BIGINT_NO_ASM)
+#define CONFIG_BIGINT_MIPS32_ASM
+#endif
+
+// SHA-256 block function is implemented in sha256_mips32.S
+#if defined(__mips__) && defined(SHA256_ASM_ENABLE)
+#define CONFIG_SHA256_MIPS32_ASM
+#endif
@@ -87,12 +87,28 @@ extern "C" {
 #define KEY_USAGE_ENCIPHER_ONLY             0x0001
 #define KEY_USAGE_DECIPHER_ONLY             0x8000
 
+#ifdef CONFIG_X509_ZERO_COPY
+/* Component of a distinguished name, it points into the DER buffer */
+typedef struct
+{
+    const uint8_t *str;
+    uint16_t len;
+    uint8_t type;
+} x509_dn_t;
+#else
+typedef char *x509_dn_t;
+#endif
+
 struct _x509_ctx
 {
-    char *ca_cert_dn[X509_NUM_DN_TYPES];
-    char *cert_dn[X509_NUM_DN_TYPES];
+    x509_dn_t ca_cert_dn[X509_NUM_DN_TYPES];
+    x509_dn_t cert_dn[X509_NUM_DN_TYPES];
     char **subject_alt_dnsnames;
+#ifdef CONFIG_X509_ZERO_COPY
+    const uint8_t *signature;
+#else
     uint8_t *signature;
+#endif
     RSA_CTX *rsa_ctx;
     bigint *digest;
     uint16_t sig_len;
@@ -173,11 +189,11 @@ int asn1_get_bool(const uint8_t *buf, int *offset, bool *val);
 int asn1_get_bit_string_as_int(const uint8_t *buf, int *offset, uint32_t *val);
 int asn1_version(const uint8_t *cert, int *offset, int *val);
 int asn1_validity(const uint8_t *cert, int *offset);
-int asn1_name(const uint8_t *cert, int *offset, char *dn[]);
+int asn1_name(const uint8_t *cert, int *offset, x509_dn_t dn[]);
 int asn1_public_key(const uint8_t *cert, int *offset, X509_CTX *x509_ctx);
 #ifdef CONFIG_SSL_CERT_VERIFICATION
 int asn1_signature(const uint8_t *cert, int *offset, X509_CTX *x509_ctx);
-int asn1_compare_dn(char * const dn1[], char * const dn2[]);
+int asn1_compare_dn(const x509_dn_t dn1[], const x509_dn_t dn2[]);
 int asn1_is_subject_alt_name(const uint8_t *cert, int offset);
 int asn1_is_basic_constraints(const uint8_t *cert, int offset);
 int asn1_is_key_usage(const uint8_t *cert, int offset);
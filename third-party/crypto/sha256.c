@@ -31,6 +31,16 @@
 #include <stdint.h>
 #include <string.h>
 #include "crypto.h"
+#include "config.h"
+
+/* Input words may be read from any byte buffer */
+typedef uint32_t __attribute__((may_alias)) sha256_word;
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define LOAD_BE32(w)    __builtin_bswap32(w)
+#else
+#define LOAD_BE32(w)    (w)
+#endif
 
 #define GET_UINT32(n,b,i)                       \
 {                                               \
@@ -74,28 +84,20 @@ void SHA256_Init(SHA256_CTX *ctx)
     ctx->state[7] = 0x5BE0CD19;
 }
 
-static void SHA256_Process(const uint8_t digest[64], SHA256_CTX *ctx)
+#ifdef CONFIG_SHA256_MIPS32_ASM
+/* sha256_mips32.S */
+void sha256_blocks(uint32_t state[8], const sha256_word *data, int blocks);
+#else
+/*
+ * Process a number of 64-byte blocks of 32-bit aligned data. The message
+ * schedule is kept in a 16-word window and computed along with the rounds.
+ */
+static void sha256_blocks(uint32_t state[8], const sha256_word *data,
+        int blocks)
 {
-    uint32_t temp1, temp2, W[64];
+    uint32_t temp1, temp2, W[16];
     uint32_t A, B, C, D, E, F, G, H;
 
-    GET_UINT32(W[0],  digest,  0);
-    GET_UINT32(W[1],  digest,  4);
-    GET_UINT32(W[2],  digest,  8);
-    GET_UINT32(W[3],  digest, 12);
-    GET_UINT32(W[4],  digest, 16);
-    GET_UINT32(W[5],  digest, 20);
-    GET_UINT32(W[6],  digest, 24);
-    GET_UINT32(W[7],  digest, 28);
-    GET_UINT32(W[8],  digest, 32);
-    GET_UINT32(W[9],  digest, 36);
-    GET_UINT32(W[10], digest, 40);
-    GET_UINT32(W[11], digest, 44);
-    GET_UINT32(W[12], digest, 48);
-    GET_UINT32(W[13], digest, 52);
-    GET_UINT32(W[14], digest, 56);
-    GET_UINT32(W[15], digest, 60);
-
 #define  SHR(x,n) ((x & 0xFFFFFFFF) >> n)
 #define ROTR(x,n) (SHR(x,n) | (x << (32 - n)))
 
@@ -108,10 +110,17 @@ static void SHA256_Process(const uint8_t digest[64], SHA256_CTX *ctx)
 #define F0(x,y,z) ((x & y) | (z & (x | y)))
 #define F1(x,y,z) (z ^ (x & (y ^ z)))
 
+#define WT(t) W[(t) & 15]
+
+#define L(t)                                    \
+(                                               \
+    WT(t) = LOAD_BE32(data[t])                  \
+)
+
 #define R(t)                                    \
-(                                              \
-    W[t] = S1(W[t -  2]) + W[t -  7] +          \
-           S0(W[t - 15]) + W[t - 16]            \
+(                                               \
+    WT(t) += S1(WT(t -  2)) + WT(t -  7) +      \
+             S0(WT(t - 15))                     \
 )
 
 #define P(a,b,c,d,e,f,g,h,x,K)                  \
@@ -121,89 +130,93 @@ static void SHA256_Process(const uint8_t digest[64], SHA256_CTX *ctx)
     d += temp1; h = temp1 + temp2;              \
 }
 
-    A = ctx->state[0];
-    B = ctx->state[1];
-    C = ctx->state[2];
-    D = ctx->state[3];
-    E = ctx->state[4];
-    F = ctx->state[5];
-    G = ctx->state[6];
-    H = ctx->state[7];
-
-    P(A, B, C, D, E, F, G, H, W[ 0], 0x428A2F98);
-    P(H, A, B, C, D, E, F, G, W[ 1], 0x71374491);
-    P(G, H, A, B, C, D, E, F, W[ 2], 0xB5C0FBCF);
-    P(F, G, H, A, B, C, D, E, W[ 3], 0xE9B5DBA5);
-    P(E, F, G, H, A, B, C, D, W[ 4], 0x3956C25B);
-    P(D, E, F, G, H, A, B, C, W[ 5], 0x59F111F1);
-    P(C, D, E, F, G, H, A, B, W[ 6], 0x923F82A4);
-    P(B, C, D, E, F, G, H, A, W[ 7], 0xAB1C5ED5);
-    P(A, B, C, D, E, F, G, H, W[ 8], 0xD807AA98);
-    P(H, A, B, C, D, E, F, G, W[ 9], 0x12835B01);
-    P(G, H, A, B, C, D, E, F, W[10], 0x243185BE);
-    P(F, G, H, A, B, C, D, E, W[11], 0x550C7DC3);
-    P(E, F, G, H, A, B, C, D, W[12], 0x72BE5D74);
-    P(D, E, F, G, H, A, B, C, W[13], 0x80DEB1FE);
-    P(C, D, E, F, G, H, A, B, W[14], 0x9BDC06A7);
-    P(B, C, D, E, F, G, H, A, W[15], 0xC19BF174);
-    P(A, B, C, D, E, F, G, H, R(16), 0xE49B69C1);
-    P(H, A, B, C, D, E, F, G, R(17), 0xEFBE4786);
-    P(G, H, A, B, C, D, E, F, R(18), 0x0FC19DC6);
-    P(F, G, H, A, B, C, D, E, R(19), 0x240CA1CC);
-    P(E, F, G, H, A, B, C, D, R(20), 0x2DE92C6F);
-    P(D, E, F, G, H, A, B, C, R(21), 0x4A7484AA);
-    P(C, D, E, F, G, H, A, B, R(22), 0x5CB0A9DC);
-    P(B, C, D, E, F, G, H, A, R(23), 0x76F988DA);
-    P(A, B, C, D, E, F, G, H, R(24), 0x983E5152);
-    P(H, A, B, C, D, E, F, G, R(25), 0xA831C66D);
-    P(G, H, A, B, C, D, E, F, R(26), 0xB00327C8);
-    P(F, G, H, A, B, C, D, E, R(27), 0xBF597FC7);
-    P(E, F, G, H, A, B, C, D, R(28), 0xC6E00BF3);
-    P(D, E, F, G, H, A, B, C, R(29), 0xD5A79147);
-    P(C, D, E, F, G, H, A, B, R(30), 0x06CA6351);
-    P(B, C, D, E, F, G, H, A, R(31), 0x14292967);
-    P(A, B, C, D, E, F, G, H, R(32), 0x27B70A85);
-    P(H, A, B, C, D, E, F, G, R(33), 0x2E1B2138);
-    P(G, H, A, B, C, D, E, F, R(34), 0x4D2C6DFC);
-    P(F, G, H, A, B, C, D, E, R(35), 0x53380D13);
-    P(E, F, G, H, A, B, C, D, R(36), 0x650A7354);
-    P(D, E, F, G, H, A, B, C, R(37), 0x766A0ABB);
-    P(C, D, E, F, G, H, A, B, R(38), 0x81C2C92E);
-    P(B, C, D, E, F, G, H, A, R(39), 0x92722C85);
-    P(A, B, C, D, E, F, G, H, R(40), 0xA2BFE8A1);
-    P(H, A, B, C, D, E, F, G, R(41), 0xA81A664B);
-    P(G, H, A, B, C, D, E, F, R(42), 0xC24B8B70);
-    P(F, G, H, A, B, C, D, E, R(43), 0xC76C51A3);
-    P(E, F, G, H, A, B, C, D, R(44), 0xD192E819);
-    P(D, E, F, G, H, A, B, C, R(45), 0xD6990624);
-    P(C, D, E, F, G, H, A, B, R(46), 0xF40E3585);
-    P(B, C, D, E, F, G, H, A, R(47), 0x106AA070);
-    P(A, B, C, D, E, F, G, H, R(48), 0x19A4C116);
-    P(H, A, B, C, D, E, F, G, R(49), 0x1E376C08);
-    P(G, H, A, B, C, D, E, F, R(50), 0x2748774C);
-    P(F, G, H, A, B, C, D, E, R(51), 0x34B0BCB5);
-    P(E, F, G, H, A, B, C, D, R(52), 0x391C0CB3);
-    P(D, E, F, G, H, A, B, C, R(53), 0x4ED8AA4A);
-    P(C, D, E, F, G, H, A, B, R(54), 0x5B9CCA4F);
-    P(B, C, D, E, F, G, H, A, R(55), 0x682E6FF3);
-    P(A, B, C, D, E, F, G, H, R(56), 0x748F82EE);
-    P(H, A, B, C, D, E, F, G, R(57), 0x78A5636F);
-    P(G, H, A, B, C, D, E, F, R(58), 0x84C87814);
-    P(F, G, H, A, B, C, D, E, R(59), 0x8CC70208);
-    P(E, F, G, H, A, B, C, D, R(60), 0x90BEFFFA);
-    P(D, E, F, G, H, A, B, C, R(61), 0xA4506CEB);
-    P(C, D, E, F, G, H, A, B, R(62), 0xBEF9A3F7);
-    P(B, C, D, E, F, G, H, A, R(63), 0xC67178F2);
-
-    ctx->state[0] += A;
-    ctx->state[1] += B;
-    ctx->state[2] += C;
-    ctx->state[3] += D;
-    ctx->state[4] += E;
-    ctx->state[5] += F;
-    ctx->state[6] += G;
-    ctx->state[7] += H;
+    for (; blocks > 0; blocks--, data += 16)
+    {
+        A = state[0];
+        B = state[1];
+        C = state[2];
+        D = state[3];
+        E = state[4];
+        F = state[5];
+        G = state[6];
+        H = state[7];
+
+        P(A, B, C, D, E, F, G, H, L( 0), 0x428A2F98);
+        P(H, A, B, C, D, E, F, G, L( 1), 0x71374491);
+        P(G, H, A, B, C, D, E, F, L( 2), 0xB5C0FBCF);
+        P(F, G, H, A, B, C, D, E, L( 3), 0xE9B5DBA5);
+        P(E, F, G, H, A, B, C, D, L( 4), 0x3956C25B);
+        P(D, E, F, G, H, A, B, C, L( 5), 0x59F111F1);
+        P(C, D, E, F, G, H, A, B, L( 6), 0x923F82A4);
+        P(B, C, D, E, F, G, H, A, L( 7), 0xAB1C5ED5);
+        P(A, B, C, D, E, F, G, H, L( 8), 0xD807AA98);
+        P(H, A, B, C, D, E, F, G, L( 9), 0x12835B01);
+        P(G, H, A, B, C, D, E, F, L(10), 0x243185BE);
+        P(F, G, H, A, B, C, D, E, L(11), 0x550C7DC3);
+        P(E, F, G, H, A, B, C, D, L(12), 0x72BE5D74);
+        P(D, E, F, G, H, A, B, C, L(13), 0x80DEB1FE);
+        P(C, D, E, F, G, H, A, B, L(14), 0x9BDC06A7);
+        P(B, C, D, E, F, G, H, A, L(15), 0xC19BF174);
+        P(A, B, C, D, E, F, G, H, R(16), 0xE49B69C1);
+        P(H, A, B, C, D, E, F, G, R(17), 0xEFBE4786);
+        P(G, H, A, B, C, D, E, F, R(18), 0x0FC19DC6);
+        P(F, G, H, A, B, C, D, E, R(19), 0x240CA1CC);
+        P(E, F, G, H, A, B, C, D, R(20), 0x2DE92C6F);
+        P(D, E, F, G, H, A, B, C, R(21), 0x4A7484AA);
+        P(C, D, E, F, G, H, A, B, R(22), 0x5CB0A9DC);
+        P(B, C, D, E, F, G, H, A, R(23), 0x76F988DA);
+        P(A, B, C, D, E, F, G, H, R(24), 0x983E5152);
+        P(H, A, B, C, D, E, F, G, R(25), 0xA831C66D);
+        P(G, H, A, B, C, D, E, F, R(26), 0xB00327C8);
+        P(F, G, H, A, B, C, D, E, R(27), 0xBF597FC7);
+        P(E, F, G, H, A, B, C, D, R(28), 0xC6E00BF3);
+        P(D, E, F, G, H, A, B, C, R(29), 0xD5A79147);
+        P(C, D, E, F, G, H, A, B, R(30), 0x06CA6351);
+        P(B, C, D, E, F, G, H, A, R(31), 0x14292967);
+        P(A, B, C, D, E, F, G, H, R(32), 0x27B70A85);
+        P(H, A, B, C, D, E, F, G, R(33), 0x2E1B2138);
+        P(G, H, A, B, C, D, E, F, R(34), 0x4D2C6DFC);
+        P(F, G, H, A, B, C, D, E, R(35), 0x53380D13);
+        P(E, F, G, H, A, B, C, D, R(36), 0x650A7354);
+        P(D, E, F, G, H, A, B, C, R(37), 0x766A0ABB);
+        P(C, D, E, F, G, H, A, B, R(38), 0x81C2C92E);
+        P(B, C, D, E, F, G, H, A, R(39), 0x92722C85);
+        P(A, B, C, D, E, F, G, H, R(40), 0xA2BFE8A1);
+        P(H, A, B, C, D, E, F, G, R(41), 0xA81A664B);
+        P(G, H, A, B, C, D, E, F, R(42), 0xC24B8B70);
+        P(F, G, H, A, B, C, D, E, R(43), 0xC76C51A3);
+        P(E, F, G, H, A, B, C, D, R(44), 0xD192E819);
+        P(D, E, F, G, H, A, B, C, R(45), 0xD6990624);
+        P(C, D, E, F, G, H, A, B, R(46), 0xF40E3585);
+        P(B, C, D, E, F, G, H, A, R(47), 0x106AA070);
+        P(A, B, C, D, E, F, G, H, R(48), 0x19A4C116);
+        P(H, A, B, C, D, E, F, G, R(49), 0x1E376C08);
+        P(G, H, A, B, C, D, E, F, R(50), 0x2748774C);
+        P(F, G, H, A, B, C, D, E, R(51), 0x34B0BCB5);
+        P(E, F, G, H, A, B, C, D, R(52), 0x391C0CB3);
+        P(D, E, F, G, H, A, B, C, R(53), 0x4ED8AA4A);
+        P(C, D, E, F, G, H, A, B, R(54), 0x5B9CCA4F);
+        P(B, C, D, E, F, G, H, A, R(55), 0x682E6FF3);
+        P(A, B, C, D, E, F, G, H, R(56), 0x748F82EE);
+        P(H, A, B, C, D, E, F, G, R(57), 0x78A5636F);
+        P(G, H, A, B, C, D, E, F, R(58), 0x84C87814);
+        P(F, G, H, A, B, C, D, E, R(59), 0x8CC70208);
+        P(E, F, G, H, A, B, C, D, R(60), 0x90BEFFFA);
+        P(D, E, F, G, H, A, B, C, R(61), 0xA4506CEB);
+        P(C, D, E, F, G, H, A, B, R(62), 0xBEF9A3F7);
+        P(B, C, D, E, F, G, H, A, R(63), 0xC67178F2);
+
+        state[0] += A;
+        state[1] += B;
+        state[2] += C;
+        state[3] += D;
+        state[4] += E;
+        state[5] += F;
+        state[6] += G;
+        state[7] += H;
+    }
 }
+#endif
 
 /**
  * Accepts an array of octets as the next portion of the message.
@@ -222,17 +235,33 @@ void SHA256_Update(SHA256_CTX *ctx, const uint8_t * msg, int len)
     if (left && len >= fill)
     {
         memcpy((void *) (ctx->buffer + left), (void *)msg, fill);
-        SHA256_Process(ctx->buffer, ctx);
+        sha256_blocks(ctx->state, (const sha256_word *)ctx->buffer, 1);
         len -= fill;
         msg  += fill;
         left = 0;
     }
 
-    while (len >= 64)
+    if (((uintptr_t)msg & 3) == 0)
+    {
+        /* aligned input is hashed in place */
+        int blocks = len / 64;
+
+        if (blocks)
+        {
+            sha256_blocks(ctx->state, (const sha256_word *)msg, blocks);
+            len -= blocks * 64;
+            msg += blocks * 64;
+        }
+    }
+    else
     {
-        SHA256_Process(msg, ctx);
-        len -= 64;
-        msg  += 64;
+        while (len >= 64)
+        {
+            memcpy((void *)ctx->buffer, (void *)msg, 64);
+            sha256_blocks(ctx->state, (const sha256_word *)ctx->buffer, 1);
+            len -= 64;
+            msg  += 64;
+        }
     }
 
     if (len)
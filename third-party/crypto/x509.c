@@ -72,6 +72,36 @@ end_get_sig:
 
 #endif
 
+#ifdef CONFIG_X509_ZERO_COPY
+/* The CA certificates of a chain and the end certificate */
+#define X509_POOL_SIZE  (CONFIG_X509_MAX_CA_CERTS + 1)
+
+static X509_CTX x509_pool[X509_POOL_SIZE];
+static bool x509_pool_used[X509_POOL_SIZE];
+
+static X509_CTX *x509_ctx_alloc(void)
+{
+    int i;
+
+    for (i = 0; i < X509_POOL_SIZE; i++)
+    {
+        if (!x509_pool_used[i])
+        {
+            x509_pool_used[i] = true;
+            memset(&x509_pool[i], 0, sizeof(X509_CTX));
+            return &x509_pool[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void x509_ctx_release(X509_CTX *x509_ctx)
+{
+    x509_pool_used[x509_ctx - x509_pool] = false;
+}
+#endif
+
 /**
  * Construct a new x509 object.
  * @return 0 if ok. < 0 if there was a problem.
@@ -86,7 +116,11 @@ int x509_new(const uint8_t *cert, int *len, X509_CTX **ctx)
     BI_CTX *bi_ctx;
 #endif
 
+#ifdef CONFIG_X509_ZERO_COPY
+    *ctx = x509_ctx_alloc();
+#else
     *ctx = (X509_CTX *)calloc(1, sizeof(X509_CTX));
+#endif
     if (*ctx == NULL)
         return X509_MALLOC_ERROR;
 
@@ -216,6 +250,7 @@ static int x509_v3_subject_alt_name(const uint8_t *cert, int offset,
         x509_ctx->subject_alt_name_is_critical = 
                         asn1_is_critical_ext(cert, &offset);
 
+#ifndef CONFIG_X509_ZERO_COPY   /* DNS names are not collected */
         if (asn1_next_obj(cert, &offset, ASN1_OCTET_STRING) > 0)
         {
             int altlen;
@@ -254,6 +289,7 @@ static int x509_v3_subject_alt_name(const uint8_t *cert, int offset,
                 }
             }
         }
+#endif
     }
 
     return X509_OK;
@@ -339,11 +375,14 @@ end_key_usage:
 void x509_free(X509_CTX *x509_ctx)
 {
     X509_CTX *next;
+#ifndef CONFIG_X509_ZERO_COPY
     int i;
+#endif
 
     if (x509_ctx == NULL)       /* if already null, then don't bother */
         return;
 
+#ifndef CONFIG_X509_ZERO_COPY
     for (i = 0; i < X509_NUM_DN_TYPES; i++)
     {
         free(x509_ctx->ca_cert_dn[i]);
@@ -351,6 +390,7 @@ void x509_free(X509_CTX *x509_ctx)
     }
 
     free(x509_ctx->signature);
+#endif
 
 #ifdef CONFIG_SSL_CERT_VERIFICATION 
     if (x509_ctx->digest)
@@ -358,6 +398,7 @@ void x509_free(X509_CTX *x509_ctx)
         bi_free(x509_ctx->rsa_ctx->bi_ctx, x509_ctx->digest);
     }
 
+#ifndef CONFIG_X509_ZERO_COPY
     if (x509_ctx->subject_alt_dnsnames)
     {
         for (i = 0; x509_ctx->subject_alt_dnsnames[i]; ++i)
@@ -365,14 +406,20 @@ void x509_free(X509_CTX *x509_ctx)
 
         free(x509_ctx->subject_alt_dnsnames);
     }
+#endif
 #endif
 
     RSA_free(x509_ctx->rsa_ctx);
     next = x509_ctx->next;
+#ifdef CONFIG_X509_ZERO_COPY
+    x509_ctx_release(x509_ctx);
+    x509_free(next);            /* clear the chain */
+#else
     if (next != NULL) {
         free(x509_ctx);
         x509_free(next);        /* clear the chain */
     }
+#endif
 }
 
 #ifdef CONFIG_SSL_CERT_VERIFICATION